@@ -0,0 +1,88 @@
+#include "pico/stdlib.h"
+
+#include "boot.h"
+#include "uart_bridge.h"
+#include "debug.h"
+
+static boot_mark_t marks[BOOT_TRACE_MAX];
+static size_t mark_count;
+static bool first_byte_seen;
+
+void boot_mark_at(const char *what, uint32_t at_us)
+{
+    if (mark_count < count_of(marks))
+    {
+        marks[mark_count].what = what;
+        marks[mark_count].at_us = at_us;
+        mark_count++;
+    }
+}
+
+void boot_mark(const char *what)
+{
+    boot_mark_at(what, time_us_32());
+}
+
+size_t boot_trace(const boot_mark_t **out)
+{
+    *out = marks;
+    return mark_count;
+}
+
+/* Debug builds only; see boot.h. */
+void boot_trace_print(void)
+{
+    for (size_t i = 0; i < mark_count; i++)
+    {
+        debug_printf("boot: %7lu us  %s\n", (unsigned long)marks[i].at_us, marks[i].what);
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  boot_step()
+ *  – run at most one due task.  Returns true once all are done.
+ * ---------------------------------------------------------------- */
+bool boot_step(boot_task_t *tasks, size_t count)
+{
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    bool all_done = true;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        boot_task_t *t = &tasks[i];
+        if (t->done)
+            continue;
+        if (now_ms < t->not_before_ms)
+        {
+            all_done = false;
+            continue;
+        }
+
+        t->run();
+        t->done = true;
+        boot_mark(t->name);
+
+        for (size_t j = i + 1; j < count; j++)
+        {
+            if (!tasks[j].done)
+                return false;
+        }
+        return all_done;
+    }
+    return all_done;
+}
+
+/* The metric the scheduler is for: time to the first forwarded byte. */
+void boot_poll(void)
+{
+    if (first_byte_seen)
+        return;
+
+    uint32_t at = uart_bridge_first_byte_us();
+    if (at)
+    {
+        first_byte_seen = true;
+        boot_mark_at("first byte", at);
+        boot_trace_print(); // debug builds: the host is there now to see it
+    }
+}
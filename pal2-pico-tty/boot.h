@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+
+#define BOOT_TRACE_MAX 16
+
+    /* ----------------------------------------------------------------
+     *  Boot scheduler
+     *
+     *  main() brings up only what the bridge needs and hands the rest
+     *  to boot_step(), called from the main loop: each pass runs the
+     *  first task in table order whose not_before_ms has come, so
+     *  the probes fill each other's waits instead of sleeping them.
+     *  Every task, and the first byte over the bridge, leaves a mark
+     *  in the boot trace, in microseconds since power‑on.
+     *
+     *  The trace shows on the OLED under ABOUT.  boot_trace_print()
+     *  only writes it out in an ENABLE_DEBUG build: otherwise stdio
+     *  is the USB side of the bridge, and the lines would land in
+     *  the host's terminal session with the PAL.
+     * ---------------------------------------------------------------- */
+
+    typedef struct
+    {
+        const char *name;
+        uint32_t not_before_ms; // since power‑on
+        void (*run)(void);
+        bool done;
+    } boot_task_t;
+
+    typedef struct
+    {
+        const char *what;
+        uint32_t at_us;
+    } boot_mark_t;
+
+    void boot_mark(const char *what);
+    void boot_mark_at(const char *what, uint32_t at_us);
+    size_t boot_trace(const boot_mark_t **out);
+    void boot_trace_print(void);
+
+    bool boot_step(boot_task_t *tasks, size_t count);
+    void boot_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,8 +8,24 @@
 #include "ssd1306.h"
 #include "sd-card/sd-card.h"
 #include "proj_hw.h"
+#include "uart_bridge.h"
+#include "pacer.h"
+#include "profiles.h"
+#include "file_stream.h"
+#include "oled_mirror.h"
+#include "recorder.h"
+#include "session_log.h"
+#include "ptp_io.h"
+#include "fastload.h"
+#include "pal_baud.h"
+#include "deck.h"
+#include "tape_out.h"
+#include "tape_in.h"
+#include "boot.h"
 #include "debug.h"
 
+/* Fixed pacing used before transfer profiles; now only the yardstick
+ * the transfer report measures against.                             */
 static const int SHORT_DELAY = 20;
 static const int LONG_DELAY = 200;
 
@@ -18,6 +34,11 @@ static const int BAR_WIDTH_CHARS = 20; // ########··············
 
 static const char DIR_SYMBOLS[] = "[]";
 
+static const uint64_t STATS_REFRESH_US = 500 * 1000;
+static const uint32_t PAL_DETECT_MS = 10 * 1000; // DETECT listens this long at most
+static const uint32_t PAL_DETECT_PULSES = 40;
+static const uint8_t TAPE_OUT_ID = 0x01; // set $17F9 to match before LOAD
+
 static const int SELECT_RETURN_CLOSE = -1;
 static const int SELECT_RETURN_NOACTION = -2;
 static const int SELECT_RETURN_CLOSE_ALL = -3;
@@ -68,7 +89,16 @@ static void oled_progress(ssd1306_tty_t *tty,
     ssd1306_draw_string(tty->ssd1306, 1, 1, 3, line);
     ssd1306_draw_string(tty->ssd1306, 4, 25, 1, file_name);
 
-    ssd1306_show(tty->ssd1306);
+    ssd1306_present(tty->ssd1306); // only the digits that changed
+    ssd1306_tty_invalidate(tty); // drawn behind the tty's back
+}
+
+/* The progress screen draws straight into the framebuffer, which
+ * ssd1306_tty_cls() leaves alone: wipe what the menu left there.   */
+static void oled_progress_start(ssd1306_tty_t *tty, uint32_t total, const char *file_name)
+{
+    ssd1306_clear(tty->ssd1306);
+    oled_progress(tty, 0, total, file_name);
 }
 
 void init_buttons(void)
@@ -275,10 +305,23 @@ int menu_select(ssd1306_tty_t *tty, dmenu_list_t *menu)
     }
 }
 
+/* ----------------------------------------------------------------
+ *  menu_about()
+ *  – boot trace in ms since power‑on, then the free heap.  The heap
+ *    probe used to run at boot; it mallocs up to 1 MB, so it waits
+ *    until someone asks.
+ * ---------------------------------------------------------------- */
 int menu_about(ssd1306_tty_t *tty)
 {
+    const boot_mark_t *marks;
+    size_t n = boot_trace(&marks);
+
     ssd1306_tty_cls(tty);
-    ssd1306_tty_puts(tty, "ABOUT");
+    for (size_t i = 0; i < n; i++)
+    {
+        ssd1306_tty_printf(tty, "%5lu %s\n", (unsigned long)(marks[i].at_us / 1000), marks[i].what);
+    }
+    ssd1306_tty_printf(tty, "FREE RAM %uK\n", (unsigned)(get_largest_alloc_block_binary2(1, 1024 * 1024) / 1024));
     ssd1306_tty_show(tty);
 
     while (true)
@@ -291,6 +334,448 @@ int menu_about(ssd1306_tty_t *tty)
     }
 }
 
+/* ----------------------------------------------------------------
+ *  menu_bridge_stats()
+ *  – live throughput / latency of the USB<->PAL bridge.
+ *    PLAY restarts the measurement window, MENU leaves.
+ * ---------------------------------------------------------------- */
+int menu_bridge_stats(ssd1306_tty_t *tty)
+{
+    uint64_t next_draw = 0;
+
+    uart_bridge_reset_stats();
+
+    while (true)
+    {
+        uint64_t now = time_us_64();
+        if (now >= next_draw)
+        {
+            bridge_stats_t st;
+            uart_bridge_get_stats(&st);
+
+            uint64_t elapsed = now - st.since_us;
+            if (elapsed == 0)
+                elapsed = 1; /* prevent /0               */
+
+            ssd1306_tty_cls(tty);
+            ssd1306_tty_printf(tty, "PAL>USB %luB/s\n",
+                               (unsigned long)((uint64_t)st.pal_to_usb.bytes * 1000000 / elapsed));
+            ssd1306_tty_printf(tty, " max %luus\n", (unsigned long)st.pal_to_usb.max_latency_us);
+            ssd1306_tty_printf(tty, "USB>PAL %luB/s\n",
+                               (unsigned long)((uint64_t)st.usb_to_pal.bytes * 1000000 / elapsed));
+            ssd1306_tty_printf(tty, " max %luus\n", (unsigned long)st.usb_to_pal.max_latency_us);
+            ssd1306_tty_printf(tty, "upload %luB\n", (unsigned long)st.upload_bytes);
+            ssd1306_tty_printf(tty, "drop %lu/%lu ovr %lu\n",
+                               (unsigned long)st.pal_to_usb.dropped,
+                               (unsigned long)st.usb_to_pal.dropped,
+                               (unsigned long)st.uart_overruns);
+            ssd1306_tty_printf(tty, "over %lus", (unsigned long)(elapsed / 1000000));
+            ssd1306_tty_show(tty);
+
+            next_draw = time_us_64() + STATS_REFRESH_US;
+        }
+
+        button_state_t btn = read_buttons_struct();
+        if (btn.menu == BUTTON_STATE_PRESSED)
+        {
+            return SELECT_RETURN_NOACTION;
+        }
+        if (btn.play == BUTTON_STATE_PRESSED)
+        {
+            uart_bridge_reset_stats();
+            next_draw = 0;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  menu_oled_mirror()
+ *  – switch the live PAL output mirror on or off and go straight
+ *    back to the main loop.
+ * ---------------------------------------------------------------- */
+int menu_oled_mirror(ssd1306_tty_t *tty)
+{
+    oled_mirror_set(tty, !oled_mirror_enabled());
+    return SELECT_RETURN_CLOSE_ALL;
+}
+
+/* ----------------------------------------------------------------
+ *  menu_session_log()
+ *  – start a timestamped session log, or stop the running one and
+ *    show what went into it.  Any button leaves the report.
+ * ---------------------------------------------------------------- */
+int menu_session_log(ssd1306_tty_t *tty)
+{
+    if (!session_log_active())
+    {
+        FRESULT fr = session_log_start();
+        if (fr != FR_OK)
+        {
+            ssd1306_tty_cls(tty);
+            ssd1306_tty_printf(tty, "LOG ERROR# %d", fr);
+            ssd1306_tty_show(tty);
+            sleep_ms(1000);
+        }
+        return SELECT_RETURN_CLOSE_ALL;
+    }
+
+    session_log_report_t r;
+    session_log_stop(&r);
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", r.path + 3); // skip "0:/"
+    ssd1306_tty_printf(tty, "%luB in %lus\n",
+                       (unsigned long)r.bytes, (unsigned long)(r.elapsed_us / 1000000));
+    ssd1306_tty_printf(tty, "%lu runs %lu blks\n",
+                       (unsigned long)r.runs, (unsigned long)r.blocks);
+    ssd1306_tty_printf(tty, "dropped %lu\n", (unsigned long)r.dropped);
+    if (r.err != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "ERROR# %d\n", r.err);
+    }
+    ssd1306_tty_show(tty);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+    return SELECT_RETURN_CLOSE_ALL;
+}
+
+/* ----------------------------------------------------------------
+ *  menu_pal_baud()
+ *  – pick a PAL link rate.  The PAL is reset and learns the new
+ *    rate from a RUBOUT, and its prompt is timed to check.  DETECT
+ *    only listens, and moves PAL_UART to whatever the PAL uses.
+ *    Any button leaves the result.
+ * ---------------------------------------------------------------- */
+int menu_pal_baud(ssd1306_tty_t *tty)
+{
+    static char labels[MAX_MENU_ITEMS][12];
+    dmenu_list_t menu = {.count = 0};
+    size_t count;
+    const uint32_t *rates = pal_baud_rates(&count);
+    uint32_t now = uart_bridge_get_baud();
+
+    add_menu_item(&menu, "DETECT", NULL);
+    for (size_t i = 0; i < count && menu.count < MAX_MENU_ITEMS; i++)
+    {
+        snprintf(labels[i], sizeof labels[i], "%c%lu", rates[i] == now ? '*' : ' ',
+                 (unsigned long)rates[i]);
+        add_menu_item(&menu, labels[i], NULL);
+    }
+
+    int selected = process_menu_inner(tty, &menu);
+    free_menu(&menu);
+    if (selected < 0)
+        return SELECT_RETURN_NOACTION;
+
+    ssd1306_tty_cls(tty);
+    if (selected == 0)
+    {
+        pal_baud_measure_t m;
+
+        ssd1306_tty_puts(tty, "DETECT\nlistening...\nmake the PAL talk");
+        ssd1306_tty_show(tty);
+
+        ssd1306_tty_cls(tty);
+        if (!pal_baud_measure(PAL_DETECT_MS, PAL_DETECT_PULSES, &m))
+        {
+            ssd1306_tty_puts(tty, "nothing heard\n");
+        }
+        else
+        {
+            ssd1306_tty_printf(tty, "bit %lu.%02lu us\n",
+                               (unsigned long)(m.bit_ns / 1000), (unsigned long)(m.bit_ns % 1000) / 10);
+            ssd1306_tty_printf(tty, "~%lu baud\n", (unsigned long)m.measured);
+            if (m.nearest)
+            {
+                ssd1306_tty_printf(tty, "link now %lu\n", (unsigned long)uart_bridge_set_baud(m.nearest));
+            }
+            else
+            {
+                ssd1306_tty_puts(tty, "not a std rate\n");
+            }
+        }
+    }
+    else
+    {
+        pal_baud_sync_t r;
+
+        ssd1306_tty_printf(tty, "PAL -> %lu\nreset + RUBOUT", (unsigned long)rates[selected - 1]);
+        ssd1306_tty_show(tty);
+
+        pal_baud_sync(rates[selected - 1], &r);
+
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_printf(tty, "link %lu baud\n", (unsigned long)r.baud);
+        ssd1306_tty_printf(tty, "%s, %lu tr%s\n", r.ok ? "PAL synced" : "NO SYNC",
+                           (unsigned long)r.tries, r.tries == 1 ? "y" : "ies");
+        if (r.m.pulses)
+        {
+            ssd1306_tty_printf(tty, "PAL ~%lu baud\n", (unsigned long)r.m.measured);
+        }
+        else
+        {
+            ssd1306_tty_puts(tty, "PAL silent\n");
+        }
+    }
+    ssd1306_tty_show(tty);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+    return SELECT_RETURN_CLOSE_ALL;
+}
+
+/* ----------------------------------------------------------------
+ *  menu_capture_dump()
+ *  – wait for the tape the PAL punches on "Q" and save it as a .prg.
+ *    Start the dump from the host terminal; MENU cancels.
+ * ---------------------------------------------------------------- */
+int menu_capture_dump(ssd1306_tty_t *tty)
+{
+    dump_report_t r;
+    uint64_t next_draw = 0;
+    uint32_t drawn = UINT32_MAX;
+
+    ptp_dump_begin();
+
+    while (!ptp_dump_poll(&r))
+    {
+        if (r.records != drawn && time_us_64() >= next_draw)
+        {
+            ssd1306_tty_cls(tty);
+            ssd1306_tty_puts(tty, "Q DUMP -> SD\n");
+            if (r.records == 0)
+            {
+                ssd1306_tty_puts(tty, "waiting for tape\n");
+            }
+            else
+            {
+                ssd1306_tty_printf(tty, "%s\n", r.path + 3);
+                ssd1306_tty_printf(tty, "%lu rec %luB\n", (unsigned long)r.records, (unsigned long)r.bytes);
+                ssd1306_tty_printf(tty, "$%04X-$%04X\n", r.first, (uint16_t)(r.next - 1));
+            }
+            ssd1306_tty_puts(tty, "MENU cancels");
+            ssd1306_tty_show(tty);
+            drawn = r.records;
+            next_draw = time_us_64() + STATS_REFRESH_US;
+        }
+
+        if (read_buttons_struct().menu == BUTTON_STATE_PRESSED)
+            break;
+    }
+
+    ptp_dump_end(&r);
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", r.records ? r.path + 3 : "no records");
+    ssd1306_tty_printf(tty, "%lu rec %luB\n", (unsigned long)r.records, (unsigned long)r.bytes);
+    if (r.records)
+    {
+        ssd1306_tty_printf(tty, "$%04X-$%04X\n", r.first, (uint16_t)(r.next - 1));
+    }
+    if (r.err)
+    {
+        ssd1306_tty_printf(tty, "ERROR %s\n", ptp_strerror(r.err));
+    }
+    else if (r.fr != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "ERROR# %d\n", r.fr);
+    }
+    else
+    {
+        ssd1306_tty_puts(tty, r.finished ? "complete\n" : "cancelled\n");
+    }
+    ssd1306_tty_show(tty);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+    return SELECT_RETURN_CLOSE_ALL;
+}
+
+/* ----------------------------------------------------------------
+ *  menu_tape_in()
+ *  – save every record the PAL writes to tape as .bin and .ptp.
+ *    Start the SAVE ($1800) from the host terminal; the bridge keeps
+ *    running throughout.  MENU stops.
+ * ---------------------------------------------------------------- */
+int menu_tape_in(ssd1306_tty_t *tty)
+{
+    tape_in_report_t r;
+    uint64_t next_draw = 0;
+
+    if (!tape_in_begin())
+    {
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_puts(tty, "TAPE IN\n\nno PIO/DMA/job\n");
+        ssd1306_tty_show(tty);
+        while (!read_buttons_struct().any)
+        {
+            tight_loop_contents();
+        }
+        return SELECT_RETURN_CLOSE_ALL;
+    }
+
+    while (read_buttons_struct().menu != BUTTON_STATE_PRESSED)
+    {
+        tape_in_poll(&r);
+
+        if (time_us_64() >= next_draw)
+        {
+            ssd1306_tty_cls(tty);
+            ssd1306_tty_printf(tty, "TAPE IN GP%d\n", TAPE_IN_GPIO);
+            if (r.in_record || r.records || r.bad)
+            {
+                ssd1306_tty_printf(tty, "%s\n", r.path + 3);
+                ssd1306_tty_printf(tty, "%s %luB\n", r.in_record ? "reading" : "last",
+                                   (unsigned long)r.bytes);
+            }
+            else
+            {
+                ssd1306_tty_puts(tty, "waiting for tape\n\n");
+            }
+            ssd1306_tty_printf(tty, "saved %lu bad %lu\n", (unsigned long)r.records,
+                               (unsigned long)r.bad);
+            ssd1306_tty_printf(tty, "%lu halves\n", (unsigned long)r.halves);
+            ssd1306_tty_puts(tty, "MENU stops");
+            ssd1306_tty_show(tty);
+            next_draw = time_us_64() + STATS_REFRESH_US;
+        }
+    }
+
+    tape_in_end(&r);
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "saved %lu bad %lu\n", (unsigned long)r.records, (unsigned long)r.bad);
+    if (r.records)
+        ssd1306_tty_printf(tty, "%s\n", r.path + 3);
+    if (r.bad)
+        ssd1306_tty_printf(tty, "last: %s\n", tape_in_strerror(r.last_err));
+    if (r.fr != FR_OK)
+        ssd1306_tty_printf(tty, "ERROR# %d\n", r.fr);
+    ssd1306_tty_printf(tty, "ovr %lu drop %lu\n", (unsigned long)r.overruns,
+                       (unsigned long)r.dropped);
+    ssd1306_tty_show(tty);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+    return SELECT_RETURN_CLOSE_ALL;
+}
+
+/* ----------------------------------------------------------------
+ *  menu_sd_benchmark()
+ *  – write/read BENCH_PATH with blocking SPI, then with DMA, and
+ *    show both side by side.  MENU leaves.
+ * ---------------------------------------------------------------- */
+int menu_sd_benchmark(ssd1306_tty_t *tty)
+{
+    sd_bench_t bench;
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_puts(tty, "SD BENCHMARK\n\nrunning...");
+    ssd1306_tty_show(tty);
+
+    FRESULT fr = sd_card_benchmark(&bench);
+
+    ssd1306_tty_cls(tty);
+    if (fr != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "SD BENCHMARK\n\nERROR# %d", fr);
+    }
+    else
+    {
+        ssd1306_tty_puts(tty, "          SPI    DMA\n");
+        ssd1306_tty_printf(tty, "W KB/s %6lu %6lu\n",
+                           (unsigned long)bench.write[SD_BENCH_SPI].kb_per_s,
+                           (unsigned long)bench.write[SD_BENCH_DMA].kb_per_s);
+        ssd1306_tty_printf(tty, "W avg  %6lu %6lu\n",
+                           (unsigned long)bench.write[SD_BENCH_SPI].avg_us,
+                           (unsigned long)bench.write[SD_BENCH_DMA].avg_us);
+        ssd1306_tty_printf(tty, "W max  %6lu %6lu\n",
+                           (unsigned long)bench.write[SD_BENCH_SPI].max_us,
+                           (unsigned long)bench.write[SD_BENCH_DMA].max_us);
+        ssd1306_tty_printf(tty, "R KB/s %6lu %6lu\n",
+                           (unsigned long)bench.read[SD_BENCH_SPI].kb_per_s,
+                           (unsigned long)bench.read[SD_BENCH_DMA].kb_per_s);
+        ssd1306_tty_printf(tty, "R avg  %6lu %6lu\n",
+                           (unsigned long)bench.read[SD_BENCH_SPI].avg_us,
+                           (unsigned long)bench.read[SD_BENCH_DMA].avg_us);
+        ssd1306_tty_printf(tty, "R max  %6lu %6lu\n",
+                           (unsigned long)bench.read[SD_BENCH_SPI].max_us,
+                           (unsigned long)bench.read[SD_BENCH_DMA].max_us);
+        ssd1306_tty_puts(tty, "latency in us");
+    }
+    ssd1306_tty_show(tty);
+
+    while (true)
+    {
+        button_state_t btn = read_buttons_struct();
+        if (btn.menu == BUTTON_STATE_PRESSED)
+        {
+            return SELECT_RETURN_NOACTION;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  menu_seek_benchmark()
+ *  – f_lseek cost on a contiguous and a fragmented file, walking the
+ *    FAT versus using a cluster link map.  MENU leaves.
+ * ---------------------------------------------------------------- */
+int menu_seek_benchmark(ssd1306_tty_t *tty)
+{
+    sd_seek_bench_t bench;
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_puts(tty, "SEEK BENCHMARK\n\nrunning...");
+    ssd1306_tty_show(tty);
+
+    FRESULT fr = sd_seek_benchmark(&bench);
+
+    ssd1306_tty_cls(tty);
+    if (fr != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "SEEK BENCHMARK\n\nERROR# %d", fr);
+    }
+    else
+    {
+        ssd1306_tty_puts(tty, "         WALK   CLMT\n");
+        ssd1306_tty_printf(tty, "C avg  %6lu %6lu\n",
+                           (unsigned long)bench.walk[SD_SEEK_CONTIG].avg_us,
+                           (unsigned long)bench.clmt[SD_SEEK_CONTIG].avg_us);
+        ssd1306_tty_printf(tty, "C max  %6lu %6lu\n",
+                           (unsigned long)bench.walk[SD_SEEK_CONTIG].max_us,
+                           (unsigned long)bench.clmt[SD_SEEK_CONTIG].max_us);
+        ssd1306_tty_printf(tty, "F avg  %6lu %6lu\n",
+                           (unsigned long)bench.walk[SD_SEEK_FRAG].avg_us,
+                           (unsigned long)bench.clmt[SD_SEEK_FRAG].avg_us);
+        ssd1306_tty_printf(tty, "F max  %6lu %6lu\n",
+                           (unsigned long)bench.walk[SD_SEEK_FRAG].max_us,
+                           (unsigned long)bench.clmt[SD_SEEK_FRAG].max_us);
+        ssd1306_tty_printf(tty, "frags C %lu F %lu\n",
+                           (unsigned long)bench.fragments[SD_SEEK_CONTIG],
+                           (unsigned long)bench.fragments[SD_SEEK_FRAG]);
+        ssd1306_tty_puts(tty, "latency in us");
+    }
+    ssd1306_tty_show(tty);
+
+    while (true)
+    {
+        button_state_t btn = read_buttons_struct();
+        if (btn.menu == BUTTON_STATE_PRESSED)
+        {
+            return SELECT_RETURN_NOACTION;
+        }
+    }
+}
+
 void tree_to_menu(DirEntry *node, dmenu_list_t *menu, int level)
 {
     while (node)
@@ -339,15 +824,76 @@ void path_up(char *path)
     }
 }
 
-void send_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
+/* ----------------------------------------------------------------
+ *  show_transfer_report()
+ *  – bytes, time and effective cps for the last upload, next to what
+ *    the fixed SHORT_DELAY/LONG_DELAY pacing would have taken, and
+ *    how many sectors the read-ahead cache served.
+ *    Any button leaves.
+ * ---------------------------------------------------------------- */
+static void show_transfer_report(ssd1306_tty_t *tty, const char *file_name,
+                                 const transfer_profile_t *profile,
+                                 const transfer_report_t *r)
 {
-#define LINE_BUF_LEN 255
+    pico_fatfs_cache_stats_t cache;
+    pico_fatfs_get_cache_stats(&cache);
+
+    uint64_t elapsed_ms = r->elapsed_us / 1000;
+    uint64_t fixed_ms = (uint64_t)(r->bytes - r->lines) * SHORT_DELAY +
+                        (uint64_t)r->lines * LONG_DELAY;
+    if (elapsed_ms == 0)
+        elapsed_ms = 1; /* prevent /0               */
 
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", file_name);
+    if (r->baud_failed)
+        ssd1306_tty_printf(tty, "no sync, %lu baud\n", (unsigned long)r->baud);
+    else
+        ssd1306_tty_printf(tty, "%s\n", profile->name);
+    ssd1306_tty_printf(tty, "%luB %lu lines\n",
+                       (unsigned long)r->bytes, (unsigned long)r->lines);
+    ssd1306_tty_printf(tty, "%lu.%01lus %lu cps\n",
+                       (unsigned long)(elapsed_ms / 1000),
+                       (unsigned long)(elapsed_ms % 1000) / 100,
+                       (unsigned long)(r->bytes * 1000ULL / elapsed_ms));
+    ssd1306_tty_printf(tty, "fixed %lus x%lu.%01lu\n",
+                       (unsigned long)(fixed_ms / 1000),
+                       (unsigned long)(fixed_ms / elapsed_ms),
+                       (unsigned long)(fixed_ms * 10 / elapsed_ms) % 10);
+    ssd1306_tty_printf(tty, "echo %lu tmo %lu\n",
+                       (unsigned long)r->echoed, (unsigned long)r->timeouts);
+    ssd1306_tty_printf(tty, "sd hit %lu miss %lu\n",
+                       (unsigned long)cache.hits, (unsigned long)cache.misses);
+    ssd1306_tty_show(tty);
+
+    debug_printf("%s: %lu bytes in %lu ms, fixed pacing %lu ms\n", file_name,
+                 (unsigned long)r->bytes, (unsigned long)elapsed_ms, (unsigned long)fixed_ms);
+    debug_printf("sector cache: %lu hit, %lu miss, %lu prefetched, %lu bypassed\n",
+                 (unsigned long)cache.hits, (unsigned long)cache.misses,
+                 (unsigned long)cache.prefetched, (unsigned long)cache.bypassed);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+}
+
+static void stream_prefetch(void *ctx)
+{
+    file_stream_prefetch((file_stream_t *)ctx);
+    pico_fatfs_prefetch(); // then refill the sector cache behind it
+    recorder_poll();       // a capture keeps running through an upload
+    session_log_poll();
+    deck_poll();
+}
+
+void send_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
+{
     char full_file_name[MAX_PATH_LEN];
     FIL fp;
     FRESULT fr;
-    UINT br;
-    char line[LINE_BUF_LEN];
+    static file_stream_t stream; // 1 KB of block buffers, keep it off the stack
+    static ptp_source_t source;  // checks or punches KIM tapes on the way
 
     size_t used = snprintf(full_file_name, MAX_PATH_LEN, "%s%s%s",
                            dir,
@@ -356,10 +902,14 @@ void send_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
 
     debug_printf("FULL FILE NAME %s\n", full_file_name);
 
-    fr = f_open(&fp, full_file_name, FA_READ);
+    fr = sd_open_fast(&fp, full_file_name, FA_READ);
     if (fr != FR_OK)
     {
-        //         return fr;
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_printf(tty, "OPEN ERROR# %d", fr);
+        ssd1306_tty_show(tty);
+        sleep_ms(2000);
+        return;
     }
 
     DWORD sz = f_size(&fp); /* Constant-time size fetch          */
@@ -368,33 +918,28 @@ void send_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
     const DWORD total = f_size(&fp);
     uint32_t last_step = 0; /* last % drawn       */
 
-    oled_progress(tty, 0, total, file_name);
+    oled_progress_start(tty, total, file_name);
 
-    while (f_gets(line, sizeof line, &fp))
-    {
-        size_t n = strlen(line);
+    const transfer_profile_t *profile = profile_for_file(file_name);
+    debug_printf("Profile: %s\n", profile->name);
 
-        for (size_t i = 0; i <= n; i++)
-        {
-            char ch = line[i];
-            uart_putc_raw(PAL_UART, (uint8_t)line[i]);
-            if (ch == '\r' || ch == '\n')
-            {
-                sleep_ms(LONG_DELAY);
-            }
-            else
-            {
-                sleep_ms(SHORT_DELAY);
-            }
-        }
-        if (n && line[n - 1] != '\n')
-        {
-            uart_putc_raw(PAL_UART, (uint8_t)'\n');
-            sleep_ms(LONG_DELAY);
-        }
+    pacer_t pacer;
+    pacer_begin(&pacer, &profile->pace);
+    pico_fatfs_reset_cache_stats();
+
+    file_stream_open(&stream, &fp);
+    ptp_source_open(&source, &stream, file_name);
+    pacer_set_idle(&pacer, stream_prefetch, &stream);
 
-        uint32_t sent = f_tell(&fp); /* bytes already read   */
-        uint32_t step = (sent * PROGRESS_STEPS) / total;
+    int ch;
+    int last = '\n';
+    while ((ch = ptp_source_getc(&source)) >= 0)
+    {
+        pacer_send(&pacer, (uint8_t)ch);
+        last = ch;
+
+        uint32_t sent = stream.consumed;
+        uint32_t step = (sent * PROGRESS_STEPS) / (total ? total : 1); // an empty file still sends the end record
 
         if (step != last_step)
         { /* crossed 1 % boundary */
@@ -403,12 +948,192 @@ void send_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
             /* term_progress(sent, total);     <-- enable if no OLED   */
         }
     }
+    if (last != '\n' && stream.err == FR_OK) // never submit a line cut off by a read error
+    {
+        pacer_send(&pacer, (uint8_t)'\n'); // terminate an unterminated last line
+    }
+
+    pacer_end(&pacer);
+
+    oled_progress(tty, stream.consumed, total, file_name);
+    sd_close_fast(&fp);
+
+    if (stream.err != FR_OK)
+    {
+        /* the stream ends early on a failed f_read: don't let that pass for EOF */
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_printf(tty, "READ ERROR# %d\nafter %lu of %lu B\n", stream.err,
+                           (unsigned long)stream.consumed, (unsigned long)total);
+        ssd1306_tty_puts(tty, "rest not sent");
+        ssd1306_tty_show(tty);
+        while (!read_buttons_struct().any)
+        {
+            tight_loop_contents();
+        }
+    }
+    else if (source.err)
+    {
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_printf(tty, "TAPE ERROR\n%s %lu\n%s\n",
+                           source.mode == PTP_SRC_HEX ? "line" : "record",
+                           (unsigned long)source.err_record, ptp_source_strerror(&source));
+        ssd1306_tty_printf(tty, "%lu records sent\nthen the end record",
+                           (unsigned long)ptp_source_records(&source));
+        ssd1306_tty_show(tty);
+        while (!read_buttons_struct().any)
+        {
+            tight_loop_contents();
+        }
+    }
 
-    oled_progress(tty, total, total, file_name);
-    f_close(&fp);
+    show_transfer_report(tty, file_name, profile, &pacer.report);
 }
 
-int menu_tty_up(ssd1306_tty_t *tty)
+typedef struct
+{
+    ssd1306_tty_t *tty;
+    const char *file_name;
+    bool started; // progress screen up, stub text cleared off
+} fastload_progress_ctx_t;
+
+static bool fastload_progress(void *ctx, uint32_t done, uint32_t total)
+{
+    fastload_progress_ctx_t *p = (fastload_progress_ctx_t *)ctx;
+
+    if (!p->started)
+    {
+        p->started = true;
+        oled_progress_start(p->tty, total, p->file_name);
+    }
+    oled_progress(p->tty, done, total, p->file_name);
+    return read_buttons_struct().menu != BUTTON_STATE_PRESSED;
+}
+
+/* ----------------------------------------------------------------
+ *  fast_load_file()
+ *  – send a .bin/.prg through the fastload stub and start it.  The
+ *    report puts the binary rate next to the text path's, measured
+ *    on the stub itself going up as tape.
+ *    Any button leaves.
+ * ---------------------------------------------------------------- */
+void fast_load_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
+{
+    char full_file_name[MAX_PATH_LEN];
+    fastload_report_t r;
+    fastload_progress_ctx_t ctx = {tty, file_name};
+
+    snprintf(full_file_name, MAX_PATH_LEN, "%s%s%s",
+             dir,
+             (dir[0] && dir[strlen(dir) - 1] != '/') ? "/" : "",
+             file_name);
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\nstub -> PAL", file_name);
+    ssd1306_tty_show(tty);
+
+    fastload_run(full_file_name, file_name, &r, fastload_progress, &ctx);
+
+    uint64_t data_ms = MAX(r.data_us / 1000, 1);
+    uint64_t stub_ms = MAX(r.stub_us / 1000, 1);
+    uint32_t fast_bps = r.bytes * 1000ULL / data_ms;
+    uint32_t text_bps = r.stub_bytes * 1000ULL / stub_ms;
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", file_name);
+    ssd1306_tty_printf(tty, "$%04X %luB\n", r.load, (unsigned long)r.bytes);
+    if (r.err)
+    {
+        ssd1306_tty_printf(tty, "ERROR %s\n", fastload_strerror(r.err));
+        if (r.err == FASTLOAD_ERR_BLOCK)
+            ssd1306_tty_printf(tty, "at $%04X\n", r.failed_addr);
+        else if (r.err == FASTLOAD_ERR_FILE)
+            ssd1306_tty_printf(tty, "FR# %d\n", r.fr);
+        if (r.stub_us)
+            ssd1306_tty_puts(tty, "reset the PAL\n");
+    }
+    else
+    {
+        ssd1306_tty_printf(tty, "%lu.%01lus %lu B/s\n",
+                           (unsigned long)(data_ms / 1000),
+                           (unsigned long)(data_ms % 1000) / 100,
+                           (unsigned long)fast_bps);
+        ssd1306_tty_printf(tty, "text %lu B/s x%lu\n",
+                           (unsigned long)text_bps,
+                           (unsigned long)(text_bps ? fast_bps / text_bps : 0));
+        ssd1306_tty_printf(tty, "%lu baud stub $%04X\n", (unsigned long)r.baud, r.stub_addr);
+        ssd1306_tty_printf(tty, "nak %lu tmo %lu\n",
+                           (unsigned long)r.naks, (unsigned long)r.timeouts);
+    }
+    ssd1306_tty_show(tty);
+
+    debug_printf("fastload %s: %lu bytes in %lu ms (%lu B/s), stub %lu bytes in %lu ms (%lu B/s)\n",
+                 file_name, (unsigned long)r.bytes, (unsigned long)data_ms, (unsigned long)fast_bps,
+                 (unsigned long)r.stub_bytes, (unsigned long)stub_ms, (unsigned long)text_bps);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  tape_out_file()
+ *  – play a .bin/.prg on TAPE_OUT_GPIO as a KIM‑1 cassette; start
+ *    the PAL's tape LOAD ($1873) first.  MENU stops the tape.
+ *    Any button leaves.
+ * ---------------------------------------------------------------- */
+void tape_out_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
+{
+    char full_file_name[MAX_PATH_LEN];
+    tape_out_report_t r;
+    fastload_progress_ctx_t ctx = {tty, file_name};
+
+    snprintf(full_file_name, MAX_PATH_LEN, "%s%s%s",
+             dir,
+             (dir[0] && dir[strlen(dir) - 1] != '/') ? "/" : "",
+             file_name);
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\ntape -> GP%d", file_name, TAPE_OUT_GPIO);
+    ssd1306_tty_show(tty);
+
+    tape_out_run(full_file_name, file_name, TAPE_OUT_ID, &r, fastload_progress, &ctx);
+
+    uint64_t ms = MAX(r.elapsed_us / 1000, 1);
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", file_name);
+    ssd1306_tty_printf(tty, "ID %02X $%04X %luB\n", r.id, r.load, (unsigned long)r.bytes);
+    if (r.err)
+    {
+        ssd1306_tty_printf(tty, "ERROR %s\n", tape_out_strerror(r.err));
+        if (r.err == TAPE_OUT_ERR_FILE)
+            ssd1306_tty_printf(tty, "FR# %d\n", r.fr);
+    }
+    else
+    {
+        ssd1306_tty_printf(tty, "CHK %04X\n", r.checksum);
+        ssd1306_tty_printf(tty, "%lu.%01lus %lu B/s\n",
+                           (unsigned long)(ms / 1000),
+                           (unsigned long)(ms % 1000) / 100,
+                           (unsigned long)(r.bytes * 1000ULL / ms));
+    }
+    ssd1306_tty_printf(tty, "%lu/%lu chars\n", (unsigned long)r.chars, (unsigned long)r.total);
+    ssd1306_tty_show(tty);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  browse_files()
+ *  – walk the card from DRIVE_PATH PTP_PATH and hand the picked
+ *    file to `action`.
+ * ---------------------------------------------------------------- */
+static int browse_files(ssd1306_tty_t *tty,
+                        void (*action)(ssd1306_tty_t *tty, const char *dir, const char *file_name))
 {
     int menu_tty_up_return = 0;
     dmenu_list_t menu = {.count = 0};
@@ -463,7 +1188,7 @@ int menu_tty_up(ssd1306_tty_t *tty)
 
         if (!item.is_dir)
         {
-            send_file(tty, current_dir, item.label);
+            action(tty, current_dir, item.label);
             menu_tty_up_return = SELECT_RETURN_CLOSE_ALL;
             break;
         }
@@ -497,6 +1222,68 @@ int menu_tty_up(ssd1306_tty_t *tty)
     return menu_tty_up_return;
 }
 
+int menu_tty_up(ssd1306_tty_t *tty)
+{
+    return browse_files(tty, send_file);
+}
+
+/* Load a tape and say how long it is; the first load of a tape (or
+ * one that changed) scans it for the index.                        */
+static void deck_load_file(ssd1306_tty_t *tty, const char *dir, const char *file_name)
+{
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\nloading...", file_name);
+    ssd1306_tty_show(tty);
+
+    FRESULT fr = deck_load(dir, file_name);
+    const deck_status_t *st = deck_status();
+
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", file_name);
+    if (fr != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "TAPE ERROR# %d\n", fr);
+    }
+    else
+    {
+        ssd1306_tty_printf(tty, "%lu records\n%luB\n", (unsigned long)st->records, (unsigned long)st->size);
+        if (st->scanned)
+            ssd1306_tty_printf(tty, "indexed in %lums\n", (unsigned long)st->scan_ms);
+        ssd1306_tty_puts(tty, "PLAY REW FF REC\n");
+    }
+    ssd1306_tty_show(tty);
+
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  menu_tape_deck()
+ *  – put a tape in the virtual deck, or take it out.  While one is
+ *    in, the transport buttons drive it from the idle screen.
+ * ---------------------------------------------------------------- */
+int menu_tape_deck(ssd1306_tty_t *tty)
+{
+    if (deck_loaded())
+    {
+        deck_eject();
+        return SELECT_RETURN_CLOSE_ALL;
+    }
+    return browse_files(tty, deck_load_file);
+}
+
+int menu_fast_load(ssd1306_tty_t *tty)
+{
+    return browse_files(tty, fast_load_file);
+}
+
+int menu_tape_out(ssd1306_tty_t *tty)
+{
+    return browse_files(tty, tape_out_file);
+}
+
 int process_menu_inner(ssd1306_tty_t *tty, dmenu_list_t *menu)
 {
     ssd1306_tty_set_scale(tty, 1);
@@ -530,9 +1317,36 @@ int process_menu(ssd1306_tty_t *tty)
 {
     dmenu_list_t menu = {.count = 0};
 
+    /* Boot leaves the card alone; the first menu is its first use. */
+    if (!sd_card_mounted())
+    {
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_puts(tty, "MOUNTING SD\n");
+        ssd1306_tty_show(tty);
+
+        FRESULT fr = (FRESULT)prep_sd_card();
+        if (fr != FR_OK)
+        {
+            ssd1306_tty_printf(tty, "SD ERR %d\n", fr);
+            ssd1306_tty_show(tty);
+            sleep_ms(1000);
+        }
+    }
+
     // ✅ Populate menu
     add_menu_item(&menu, "ABOUT", menu_about);
     add_menu_item(&menu, "TTY UP", menu_tty_up);
+    add_menu_item(&menu, "FAST LOAD", menu_fast_load);
+    add_menu_item(&menu, "TAPE OUT", menu_tape_out);
+    add_menu_item(&menu, "TAPE IN", menu_tape_in);
+    add_menu_item(&menu, deck_loaded() ? "EJECT TAPE" : "LOAD TAPE", menu_tape_deck);
+    add_menu_item(&menu, "BRIDGE STATS", menu_bridge_stats);
+    add_menu_item(&menu, "PAL BAUD", menu_pal_baud);
+    add_menu_item(&menu, oled_mirror_enabled() ? "MIRROR OFF" : "MIRROR ON", menu_oled_mirror);
+    add_menu_item(&menu, session_log_active() ? "LOG STOP" : "LOG START", menu_session_log);
+    add_menu_item(&menu, "CAPTURE DUMP", menu_capture_dump);
+    add_menu_item(&menu, "SD BENCHMARK", menu_sd_benchmark);
+    add_menu_item(&menu, "SEEK BENCHMARK", menu_seek_benchmark);
     add_menu_item(&menu, "Option 1", NULL);
     add_menu_item(&menu, "Option 2", NULL);
 
@@ -75,6 +75,8 @@ State machine
          - Enter Number
       . Line Delay
           - Enter Delay
+      (Baud / delays per file type now come from the transfer
+       profiles in 0:/pal2tty.cfg, see profiles.c)
 
 
 */
\ No newline at end of file
@@ -0,0 +1,425 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "deck.h"
+#include "file_stream.h"
+#include "profiles.h"
+#include "uart_bridge.h"
+#include "recorder.h"
+#include "session_log.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define DECK_RING_SIZE (8 * 1024) // RECORD: PAL output waiting for the card
+#define DECK_INDEX_BATCH 128      // offsets per index write (one sector)
+
+#define DECK_INDEX_MAGIC 0x31584944 // "DIX1"
+
+/* <tape>.idx: this header, then a uint32 start offset per record.
+ * It belongs to the tape only while size, date and time match.     */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t size;
+    uint16_t fdate, ftime;
+    uint32_t records;
+} deck_index_header_t;
+
+static FIL tape_fp;
+static FIL index_fp;
+static bool loaded;
+static char tape_path[MAX_PATH_LEN];
+static char index_path[MAX_PATH_LEN + sizeof DECK_INDEX_EXT];
+static deck_status_t st;
+
+static uint8_t deck_storage[DECK_RING_SIZE];
+static bridge_tap_t deck_tap;
+static bool at_line_start; // RECORD: the next byte appended starts a record
+static uint64_t record_start_us;
+
+static uint32_t batch[DECK_INDEX_BATCH]; // offsets not yet in the index
+static uint32_t batch_len;
+static uint8_t scan_buf[STREAM_BLOCK_SIZE];
+
+static void fail(FRESULT fr)
+{
+    if (fr != FR_OK && st.err == FR_OK)
+    {
+        st.err = fr;
+        debug_printf("deck: error %d\n", fr);
+    }
+}
+
+/* Start of record i; the end of the tape for i == records. */
+static uint32_t index_entry(uint32_t i)
+{
+    uint32_t off;
+    UINT br = 0;
+
+    if (i >= st.records)
+        return st.size;
+    if (i == 0)
+        return 0;
+
+    FRESULT fr = f_lseek(&index_fp, sizeof(deck_index_header_t) + i * sizeof off);
+    if (fr == FR_OK)
+        fr = f_read(&index_fp, &off, sizeof off, &br);
+    if (fr != FR_OK || br != sizeof off)
+    {
+        fail(fr != FR_OK ? fr : FR_INT_ERR);
+        return st.size;
+    }
+    return off;
+}
+
+static void flush_entries(void)
+{
+    UINT bw;
+
+    if (batch_len == 0)
+        return;
+
+    FRESULT fr = f_lseek(&index_fp, sizeof(deck_index_header_t) + st.records * sizeof batch[0]);
+    if (fr == FR_OK)
+        fr = f_write(&index_fp, batch, batch_len * sizeof batch[0], &bw);
+    fail(fr);
+    st.records += batch_len;
+    batch_len = 0;
+}
+
+static void add_entry(uint32_t off)
+{
+    batch[batch_len++] = off;
+    if (batch_len == DECK_INDEX_BATCH)
+        flush_entries();
+}
+
+/* Header last, so a half-written index never passes for a good one. */
+static void write_header(void)
+{
+    FILINFO fno;
+    deck_index_header_t h = {0};
+    UINT bw;
+
+    FRESULT fr = f_stat(tape_path, &fno);
+    if (fr == FR_OK)
+    {
+        h.magic = DECK_INDEX_MAGIC;
+        h.size = (uint32_t)fno.fsize;
+        h.fdate = fno.fdate;
+        h.ftime = fno.ftime;
+        h.records = st.records;
+        fr = f_lseek(&index_fp, 0);
+    }
+    if (fr == FR_OK)
+        fr = f_write(&index_fp, &h, sizeof h, &bw);
+    if (fr == FR_OK)
+        fr = f_sync(&index_fp);
+    fail(fr);
+}
+
+static bool index_matches(const FILINFO *tape)
+{
+    deck_index_header_t h;
+    UINT br = 0;
+
+    if (f_open(&index_fp, index_path, FA_READ | FA_WRITE) != FR_OK)
+        return false;
+
+    if (f_read(&index_fp, &h, sizeof h, &br) == FR_OK && br == sizeof h &&
+        h.magic == DECK_INDEX_MAGIC && h.size == tape->fsize &&
+        h.fdate == tape->fdate && h.ftime == tape->ftime &&
+        f_size(&index_fp) == sizeof h + (FSIZE_t)h.records * sizeof(uint32_t))
+    {
+        st.records = h.records;
+        return true;
+    }
+
+    f_close(&index_fp);
+    return false;
+}
+
+/* ----------------------------------------------------------------
+ *  build_index()
+ *  – one pass over the tape noting where every line starts.  Only
+ *    done when the tape is new or has changed since the last scan.
+ * ---------------------------------------------------------------- */
+static FRESULT build_index(void)
+{
+    deck_index_header_t blank = {0};
+    uint64_t t0 = time_us_64();
+    uint32_t off = 0;
+    bool line_start = true;
+    UINT n;
+
+    FRESULT fr = f_open(&index_fp, index_path, FA_READ | FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK)
+        fr = f_write(&index_fp, &blank, sizeof blank, &n);
+    if (fr != FR_OK)
+        return fr;
+
+    st.records = 0;
+    batch_len = 0;
+    while ((fr = f_read(&tape_fp, scan_buf, sizeof scan_buf, &n)) == FR_OK && n > 0)
+    {
+        for (UINT i = 0; i < n; i++, off++)
+        {
+            if (line_start)
+                add_entry(off);
+            line_start = scan_buf[i] == '\n';
+        }
+    }
+    flush_entries();
+    if (fr == FR_OK)
+        fr = st.err;
+    if (fr == FR_OK)
+        write_header();
+
+    st.scanned = true;
+    st.scan_ms = (uint32_t)((time_us_64() - t0) / 1000);
+    debug_printf("deck: indexed %lu records in %lu ms\n",
+                 (unsigned long)st.records, (unsigned long)st.scan_ms);
+    return fr != FR_OK ? fr : st.err;
+}
+
+/* ----------------------------------------------------------------
+ *  deck_load()
+ *  – put a tape in the deck, wound to the start.  The index beside
+ *    it is reused when it still matches, otherwise rebuilt.
+ * ---------------------------------------------------------------- */
+FRESULT deck_load(const char *dir, const char *file_name)
+{
+    FILINFO fno;
+
+    deck_eject();
+    memset(&st, 0, sizeof st);
+
+    snprintf(tape_path, sizeof tape_path, "%s%s%s", dir,
+             (dir[0] && dir[strlen(dir) - 1] != '/') ? "/" : "", file_name);
+    snprintf(index_path, sizeof index_path, "%s%s", tape_path, DECK_INDEX_EXT);
+    snprintf(st.name, sizeof st.name, "%s", file_name);
+
+    FRESULT fr = f_stat(tape_path, &fno);
+    if (fr == FR_OK)
+        fr = sd_open_fast(&tape_fp, tape_path, FA_READ);
+    if (fr != FR_OK)
+        return st.err = fr;
+    st.size = (uint32_t)fno.fsize;
+
+    if (!index_matches(&fno))
+    {
+        fr = build_index();
+        if (fr != FR_OK)
+        {
+            f_close(&index_fp);
+            sd_close_fast(&tape_fp);
+            return st.err = fr;
+        }
+    }
+
+    loaded = true;
+    debug_printf("deck: %s, %lu bytes, %lu records%s\n", tape_path, (unsigned long)st.size,
+                 (unsigned long)st.records, st.scanned ? " (scanned)" : "");
+    return FR_OK;
+}
+
+void deck_eject(void)
+{
+    if (!loaded)
+        return;
+
+    deck_record_stop();
+    f_close(&index_fp);
+    sd_close_fast(&tape_fp);
+    loaded = false;
+}
+
+bool deck_loaded(void)
+{
+    return loaded;
+}
+
+const deck_status_t *deck_status(void)
+{
+    return &st;
+}
+
+/* ----------------------------------------------------------------
+ *  deck_wind()
+ *  – FF (records > 0) or REWIND (< 0) that many record starts.  The
+ *    first REWIND from part way into a record goes back to its start,
+ *    like cueing a cassette.
+ * ---------------------------------------------------------------- */
+void deck_wind(int32_t records)
+{
+    if (!loaded || st.recording || records == 0)
+        return;
+
+    int64_t r = st.record;
+    if (records < 0 && r < st.records && st.cursor > index_entry(r))
+        records++;
+
+    r += records;
+    r = MAX(r, 0);
+    r = MIN(r, (int64_t)st.records);
+
+    st.record = (uint32_t)r;
+    st.cursor = index_entry(st.record);
+}
+
+static void play_idle(void *ctx)
+{
+    file_stream_prefetch((file_stream_t *)ctx);
+    pico_fatfs_prefetch();
+    recorder_poll();
+    session_log_poll();
+}
+
+/* ----------------------------------------------------------------
+ *  deck_play()
+ *  – send the tape from the cursor with the tape's transfer profile
+ *    until it runs out or `cb` says stop.  The cursor stays where
+ *    PLAY left off.
+ * ---------------------------------------------------------------- */
+void deck_play(deck_play_cb_t cb, void *ctx, transfer_report_t *out)
+{
+    static file_stream_t stream;
+    pacer_t pacer;
+    int c;
+
+    if (!loaded || st.recording)
+        return;
+
+    FRESULT fr = f_lseek(&tape_fp, st.cursor);
+    if (fr != FR_OK)
+    {
+        fail(fr);
+        return;
+    }
+
+    pacer_begin(&pacer, &profile_for_file(st.name)->pace);
+    file_stream_open(&stream, &tape_fp);
+    pacer_set_idle(&pacer, play_idle, &stream);
+
+    while ((c = file_stream_getc(&stream)) >= 0)
+    {
+        pacer_send(&pacer, (uint8_t)c);
+        st.cursor++;
+        if (c == '\n' && st.cursor < st.size)
+            st.record++;
+        if (cb && !cb(ctx, &st))
+            break;
+    }
+    if (c < 0)
+    {
+        st.record = st.records; // at the end
+        fail(stream.err);
+    }
+
+    pacer_end(&pacer);
+    if (out)
+        *out = pacer.report;
+}
+
+/* ----------------------------------------------------------------
+ *  deck_record_start() / deck_poll() / deck_record_stop()
+ *  – append PAL output to the end of the tape, indexing new lines
+ *    as they are written.  The cursor does not move.
+ * ---------------------------------------------------------------- */
+FRESULT deck_record_start(void)
+{
+    uint8_t last = '\n';
+    UINT br;
+
+    if (!loaded || st.recording)
+        return st.err;
+
+    if (st.size)
+    {
+        FRESULT fr = f_lseek(&tape_fp, st.size - 1);
+        if (fr == FR_OK)
+            fr = f_read(&tape_fp, &last, 1, &br);
+        fail(fr);
+    }
+    at_line_start = last == '\n';
+
+    sd_close_fast(&tape_fp);
+    FRESULT fr = f_open(&tape_fp, tape_path, FA_WRITE | FA_OPEN_APPEND);
+    if (fr == FR_OK && !uart_bridge_tap_attach(&deck_tap, deck_storage, sizeof deck_storage))
+    {
+        f_close(&tape_fp);
+        fr = FR_TOO_MANY_OPEN_FILES;
+    }
+    if (fr != FR_OK)
+    {
+        fail(fr);
+        fail(sd_open_fast(&tape_fp, tape_path, FA_READ));
+        return fr;
+    }
+
+    st.rec_bytes = 0;
+    st.rec_dropped = 0;
+    st.recording = true;
+    record_start_us = time_us_64();
+    return FR_OK;
+}
+
+static void append_ring(void)
+{
+    const uint8_t *p;
+    uint32_t run;
+
+    while ((run = spsc_ring_peek(&deck_tap.ring, &p)) > 0)
+    {
+        UINT bw = 0;
+        FRESULT fr = f_write(&tape_fp, p, run, &bw);
+
+        for (UINT i = 0; i < bw; i++)
+        {
+            if (at_line_start)
+                add_entry(st.size + i);
+            at_line_start = p[i] == '\n';
+        }
+        st.size += bw;
+        st.rec_bytes += bw;
+        spsc_ring_consume(&deck_tap.ring, bw);
+
+        if (fr != FR_OK || bw < run)
+        {
+            fail(fr != FR_OK ? fr : FR_DENIED); // card full
+            spsc_ring_consume(&deck_tap.ring, spsc_ring_count(&deck_tap.ring));
+            return;
+        }
+    }
+}
+
+void deck_poll(void)
+{
+    if (st.recording && st.err == FR_OK)
+        append_ring();
+}
+
+void deck_record_stop(void)
+{
+    if (!st.recording)
+        return;
+
+    uart_bridge_tap_detach(&deck_tap);
+    st.recording = false;
+    if (st.err == FR_OK)
+        append_ring();
+    st.rec_dropped = deck_tap.dropped;
+
+    fail(f_close(&tape_fp));
+    flush_entries();
+    write_header();
+    fail(sd_open_fast(&tape_fp, tape_path, FA_READ));
+
+    debug_printf("deck: recorded %lu bytes (%lu dropped) in %lu ms, now %lu records\n",
+                 (unsigned long)st.rec_bytes, (unsigned long)st.rec_dropped,
+                 (unsigned long)((time_us_64() - record_start_us) / 1000),
+                 (unsigned long)st.records);
+}
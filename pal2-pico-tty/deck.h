@@ -0,0 +1,50 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "sd-card/sd-card.h"
+#include "pacer.h"
+
+#define DECK_INDEX_EXT ".idx" // "tape.ptp" -> "tape.ptp.idx", beside it
+
+    /* A virtual cassette deck.  The tape is any file on the card; its
+     * records are its lines (one per record on a KIM paper tape, one
+     * per program line in a BASIC listing).  Where each one starts is
+     * scanned once and kept in DECK_INDEX_EXT, so winding is a seek
+     * and a 4-byte read however long the tape is.                    */
+    typedef struct
+    {
+        char name[MAX_NAME_LEN];
+        uint32_t size;       // tape length in bytes
+        uint32_t cursor;     // next byte PLAY sends
+        uint32_t record;     // record the cursor is in; == records at the end
+        uint32_t records;
+        bool recording;
+        bool scanned;        // the index was (re)built on load
+        uint32_t scan_ms;
+        uint32_t rec_bytes;  // appended by the current/last RECORD
+        uint32_t rec_dropped;
+        FRESULT err;         // first error, FR_OK if none
+    } deck_status_t;
+
+    /* Called for every byte PLAY sends; return false to stop there. */
+    typedef bool (*deck_play_cb_t)(void *ctx, const deck_status_t *st);
+
+    FRESULT deck_load(const char *dir, const char *file_name);
+    void deck_eject(void);
+    bool deck_loaded(void);
+    const deck_status_t *deck_status(void);
+
+    void deck_wind(int32_t records);
+    void deck_play(deck_play_cb_t cb, void *ctx, transfer_report_t *out);
+    FRESULT deck_record_start(void);
+    void deck_record_stop(void);
+    void deck_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,511 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "fastload.h"
+#include "kim_ptp.h"
+#include "ptp_io.h"
+#include "pacer.h"
+#include "profiles.h"
+#include "uart_bridge.h"
+#include "recorder.h"
+#include "session_log.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define FASTLOAD_CPU_HZ 1000000 // PAL clock; the stub times its own bits
+#define FASTLOAD_DELAY 4        // stub bit time 5*D+17 cycles, D >= 3 (4: 27027 baud at 1 MHz)
+#define FASTLOAD_RETRIES 5      // per block
+#define FASTLOAD_CRC_CYCLES 210 // stub CRC time per byte, worst case
+#define FASTLOAD_SLACK_MS 100   // on top of wire + CRC time for an answer
+#define FASTLOAD_ENQ_MS 2       // wait for an answer to each ENQ
+#define FASTLOAD_SETTLE_MS 100  // quiet that ends a resync
+#define REPLY_TAP_SIZE 512       // a whole block's echo, and the answer behind it
+
+#define SOH 0x01
+#define EOT 0x04
+#define ENQ 0x05
+#define ACK 0x06
+#define NAK 0x15
+
+/* ----------------------------------------------------------------
+ *  The stub, assembled for $0000.  Zero page $F6‑$FE is the
+ *  monitor's own scratch (CHKHI..CHAR), free once G has left it.
+ *  RX/TX bit‑bang PA7/PB0 rather than calling GETCH/OUTCH: GETCH
+ *  drops bit 7 and both run at the monitor's rate.
+ * ---------------------------------------------------------------- */
+static const uint8_t stub_code[] = {
+    0xD8,             // 00  START:  CLD
+    0x20, 0xA9, 0x00, // 01  CMD:    JSR RX           ; command byte
+    0xC9, 0x01,       // 04          CMP #SOH
+    0xF0, 0x08,       // 06          BEQ BLOCK
+    0xC9, 0x04,       // 08          CMP #EOT
+    0xF0, 0x6E,       // 0A          BEQ RUN
+    0xA9, 0x06,       // 0C          LDA #ACK         ; anything else: "still here"
+    0xD0, 0x65,       // 0E          BNE REPLY
+    0x20, 0xA9, 0x00, // 10  BLOCK:  JSR RX           ; SOH lo hi len data.. crc_hi crc_lo
+    0x85, 0xFA,       // 13          STA $FA          ; PTR
+    0x20, 0xA9, 0x00, // 15          JSR RX
+    0x85, 0xFB,       // 18          STA $FB
+    0x20, 0xA9, 0x00, // 1A          JSR RX
+    0x85, 0xFC,       // 1D          STA $FC          ; LEN, 0 = 256
+    0xA9, 0x00,       // 1F          LDA #0
+    0x85, 0xFD,       // 21          STA $FD          ; IDX: RX runs X and Y
+    0x20, 0xA9, 0x00, // 23  BLKB:   JSR RX
+    0xA4, 0xFD,       // 26          LDY $FD
+    0x91, 0xFA,       // 28          STA ($FA),Y
+    0xE6, 0xFD,       // 2A          INC $FD
+    0xA5, 0xFD,       // 2C          LDA $FD
+    0xC5, 0xFC,       // 2E          CMP $FC
+    0xD0, 0xF1,       // 30          BNE BLKB
+    0x20, 0xA9, 0x00, // 32          JSR RX
+    0x85, 0xF9,       // 35          STA $F9          ; CRC as sent
+    0x20, 0xA9, 0x00, // 37          JSR RX
+    0x85, 0xF8,       // 3A          STA $F8
+    0xA9, 0x00,       // 3C          LDA #0           ; CRC‑16/XMODEM of what is in RAM
+    0x85, 0xF6,       // 3E          STA $F6
+    0x85, 0xF7,       // 40          STA $F7
+    0xA8,             // 42          TAY
+    0xB1, 0xFA,       // 43  CRCB:   LDA ($FA),Y
+    0x45, 0xF7,       // 45          EOR $F7
+    0x85, 0xF7,       // 47          STA $F7
+    0xA2, 0x08,       // 49          LDX #8
+    0x06, 0xF6,       // 4B  CRCBIT: ASL $F6
+    0x26, 0xF7,       // 4D          ROL $F7
+    0x90, 0x0C,       // 4F          BCC CRCN
+    0xA5, 0xF7,       // 51          LDA $F7
+    0x49, 0x10,       // 53          EOR #$10
+    0x85, 0xF7,       // 55          STA $F7
+    0xA5, 0xF6,       // 57          LDA $F6
+    0x49, 0x21,       // 59          EOR #$21
+    0x85, 0xF6,       // 5B          STA $F6
+    0xCA,             // 5D  CRCN:   DEX
+    0xD0, 0xEB,       // 5E          BNE CRCBIT
+    0xC8,             // 60          INY
+    0xC4, 0xFC,       // 61          CPY $FC
+    0xD0, 0xDE,       // 63          BNE CRCB
+    0xA9, 0x15,       // 65          LDA #NAK
+    0xA6, 0xF6,       // 67          LDX $F6
+    0xE4, 0xF8,       // 69          CPX $F8
+    0xD0, 0x08,       // 6B          BNE REPLY
+    0xA6, 0xF7,       // 6D          LDX $F7
+    0xE4, 0xF9,       // 6F          CPX $F9
+    0xD0, 0x02,       // 71          BNE REPLY
+    0xA9, 0x06,       // 73          LDA #ACK
+    0x20, 0x8C, 0x00, // 75  REPLY:  JSR TX           ; returns with Z set
+    0xF0, 0x87,       // 78          BEQ CMD
+    0x20, 0xA9, 0x00, // 7A  RUN:    JSR RX           ; EOT lo hi
+    0x85, 0xFA,       // 7D          STA $FA
+    0x20, 0xA9, 0x00, // 7F          JSR RX
+    0x85, 0xFB,       // 82          STA $FB
+    0xA9, 0x06,       // 84          LDA #ACK
+    0x20, 0x8C, 0x00, // 86          JSR TX
+    0x6C, 0xFA, 0x00, // 89          JMP ($00FA)
+    0x85, 0xFE,       // 8C  TX:     STA $FE          ; 8N1 on PB0
+    0xA2, 0x0A,       // 8E          LDX #10
+    0x18,             // 90          CLC              ; start bit
+    0xAD, 0x42, 0x17, // 91  TXBIT:  LDA $1742        ; SBD
+    0x29, 0xFE,       // 94          AND #$FE
+    0x90, 0x02,       // 96          BCC TXOUT
+    0x09, 0x01,       // 98          ORA #$01
+    0x8D, 0x42, 0x17, // 9A  TXOUT:  STA $1742
+    0xA0, 0x02,       // 9D          LDY #DT          ; 5*DT+26.5 cycles a bit
+    0x88,             // 9F  TXDLY:  DEY
+    0xD0, 0xFD,       // A0          BNE TXDLY
+    0x38,             // A2          SEC              ; stop bit shifts in behind
+    0x66, 0xFE,       // A3          ROR $FE
+    0xCA,             // A5          DEX
+    0xD0, 0xE9,       // A6          BNE TXBIT
+    0x60,             // A8          RTS
+    0xAD, 0x40, 0x17, // A9  RX:     LDA $1740        ; SAD: wait for the start bit
+    0x30, 0xFB,       // AC          BMI RX
+    0xA0, 0x09,       // AE          LDY #D15         ; on to the middle of bit 0
+    0x88,             // B0  RXDLY1: DEY
+    0xD0, 0xFD,       // B1          BNE RXDLY1
+    0xA2, 0x08,       // B3          LDX #8
+    0xAD, 0x40, 0x17, // B5  RXBIT:  LDA $1740        ; 5*D+17 cycles a bit
+    0x0A,             // B8          ASL A
+    0x66, 0xFE,       // B9          ROR $FE
+    0xA0, 0x04,       // BB          LDY #D
+    0x88,             // BD  RXDLY:  DEY
+    0xD0, 0xFD,       // BE          BNE RXDLY
+    0xCA,             // C0          DEX
+    0xD0, 0xF2,       // C1          BNE RXBIT
+    0xA5, 0xFE,       // C3          LDA $FE
+    0x60,             // C5          RTS
+};
+
+/* operands of JSR to move with the stub, and the delay constants */
+static const uint8_t stub_relocs[] = {0x02, 0x11, 0x16, 0x1B, 0x24, 0x33, 0x38, 0x76, 0x7B, 0x80, 0x87};
+#define STUB_PATCH_DT 0x9E
+#define STUB_PATCH_D15 0xAF
+#define STUB_PATCH_D 0xBC
+
+#define STUB_ZP_FIRST 0xF6
+#define STUB_ZP_END 0xFF
+
+/* Where the stub may go, first that misses the image wins:
+ * the top of the 1K, then the bottom of page 2.               */
+static const uint16_t stub_sites[] = {0x0400 - sizeof stub_code, 0x0200};
+
+static uint8_t reply_storage[REPLY_TAP_SIZE];
+static bridge_tap_t reply_tap;
+static uint8_t block[FASTLOAD_BLOCK];
+static bool link_echoes; // resync() saw the PAL echo its ENQ
+
+static uint32_t bit_cycles(void)
+{
+    return 5 * FASTLOAD_DELAY + 17;
+}
+
+static bool overlaps(uint32_t a, uint32_t a_len, uint32_t b, uint32_t b_len)
+{
+    return a < b + b_len && b < a + a_len;
+}
+
+static uint16_t crc16_xmodem(const uint8_t *p, uint32_t len)
+{
+    uint16_t crc = 0;
+
+    while (len--)
+    {
+        crc ^= (uint16_t)*p++ << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+bool fastload_supported(const char *file_name)
+{
+    return ptp_source_mode(file_name) == PTP_SRC_BIN;
+}
+
+/* ----------------------------------------------------------------
+ *  send_stub()
+ *  – relocate and tune the stub, punch it as tape for L and start
+ *    it with G, all through the pacer like any other upload.
+ * ---------------------------------------------------------------- */
+static void send_stub(uint16_t at, fastload_report_t *r)
+{
+    uint8_t code[sizeof stub_code];
+    char line[PTP_LINE_MAX + 1];
+    char cmd[16];
+    ptp_encoder_t enc;
+    pacer_t pacer;
+
+    memcpy(code, stub_code, sizeof code);
+    for (size_t i = 0; i < sizeof stub_relocs; i++)
+    {
+        uint16_t a = code[stub_relocs[i]] | code[stub_relocs[i] + 1] << 8;
+        a += at;
+        code[stub_relocs[i]] = a & 0xFF;
+        code[stub_relocs[i] + 1] = a >> 8;
+    }
+    code[STUB_PATCH_D] = FASTLOAD_DELAY;
+    code[STUB_PATCH_DT] = FASTLOAD_DELAY - 2;          // TX loop is ~10 cycles longer
+    code[STUB_PATCH_D15] = (3 * bit_cycles() - 20) / 10; // 1.5 bits less the poll and setup
+
+    /* the stub's bit timing above is for the current rate: keep it */
+    pace_config_t pace = profile_for_file("stub.ptp")->pace;
+    pace.baud = 0;
+    pacer_begin(&pacer, &pace);
+
+    pacer_send(&pacer, '\r');
+    pacer_send(&pacer, 'L');
+
+    ptp_encoder_init(&enc, at, PTP_DUMP_BYTES);
+    for (size_t i = 0; i <= sizeof code; i++)
+    {
+        size_t n = i < sizeof code ? ptp_encode_byte(&enc, code[i], line)
+                                   : ptp_encode_end(&enc, line);
+        for (size_t k = 0; k < n; k++)
+            pacer_send(&pacer, (uint8_t)line[k]);
+    }
+
+    int n = snprintf(cmd, sizeof cmd, "%04X G", at);
+    for (int k = 0; k < n; k++)
+        pacer_send(&pacer, (uint8_t)cmd[k]);
+
+    pacer_end(&pacer);
+    r->stub_us = pacer.report.elapsed_us;
+}
+
+static int wait_reply(uint32_t timeout_ms)
+{
+    absolute_time_t until = make_timeout_time_ms(timeout_ms);
+    uint8_t c;
+
+    while (!spsc_ring_pop(&reply_tap.ring, &c))
+    {
+        if (time_reached(until))
+            return -1;
+        recorder_poll(); // a capture keeps running through the load
+        session_log_poll();
+    }
+    return c;
+}
+
+/* The stub's answer to the last `sent` bytes.  The KIM‑1 echoes
+ * what it receives bit by bit, stub or not, so with link_echoes
+ * those bytes come back first, all before the answer: skip exactly
+ * that many.  The timeout covers the lot.                         */
+static int wait_answer(uint32_t sent, uint32_t timeout_ms)
+{
+    absolute_time_t until = make_timeout_time_ms(timeout_ms);
+    uint32_t echo = link_echoes ? sent : 0;
+    int c;
+
+    do
+    {
+        int64_t left_us = absolute_time_diff_us(get_absolute_time(), until);
+        c = wait_reply(left_us > 0 ? (uint32_t)((left_us + 999) / 1000) : 0);
+    } while (c >= 0 && echo--);
+    return c;
+}
+
+static void drain_replies(uint32_t quiet_ms)
+{
+    while (wait_reply(quiet_ms) >= 0)
+        ;
+}
+
+/* ----------------------------------------------------------------
+ *  resync()
+ *  – bring the stub back to its command loop.  If it is part way
+ *    into a block, ENQs fill the block up and it answers NAK; one
+ *    at a time so a misframed ENQ (all ones after the low bits)
+ *    can never read as SOH or EOT.  The stub never sends ENQ, so
+ *    one coming back is the echo, not an answer.  Then one clean
+ *    ENQ -> ACK, which also tells whether the link echoes: ENQ ACK
+ *    or just ACK.
+ * ---------------------------------------------------------------- */
+static bool resync(void)
+{
+    int reply = -1;
+
+    for (int i = 0; i < FASTLOAD_BLOCK + 8 && reply < 0; i++)
+    {
+        uart_bridge_putc(ENQ);
+        absolute_time_t until = make_timeout_time_ms(FASTLOAD_ENQ_MS);
+        do
+        {
+            reply = wait_reply(FASTLOAD_ENQ_MS);
+        } while (reply == ENQ && !time_reached(until));
+        if (reply == ENQ)
+            reply = -1;
+    }
+    if (reply < 0)
+        return false;
+
+    drain_replies(FASTLOAD_SETTLE_MS);
+    uart_bridge_putc(ENQ);
+    reply = wait_reply(FASTLOAD_SLACK_MS);
+    link_echoes = reply == ENQ;
+    if (link_echoes)
+        reply = wait_reply(FASTLOAD_SLACK_MS);
+    return reply == ACK;
+}
+
+static int send_block(uint16_t addr, uint32_t len, uint32_t timeout_ms)
+{
+    uint16_t crc = crc16_xmodem(block, len);
+
+    uart_bridge_putc(SOH);
+    uart_bridge_putc(addr & 0xFF);
+    uart_bridge_putc(addr >> 8);
+    uart_bridge_putc((uint8_t)len); // 256 goes as 0
+    for (uint32_t i = 0; i < len; i++)
+        uart_bridge_putc(block[i]);
+    uart_bridge_putc(crc >> 8);
+    uart_bridge_putc(crc & 0xFF);
+
+    return wait_answer(len + 6, timeout_ms);
+}
+
+static void fail(fastload_report_t *r, int err)
+{
+    if (!r->err)
+        r->err = err;
+}
+
+/* ----------------------------------------------------------------
+ *  send_image()
+ *  – the binary phase: blocks until done, each retried on NAK or
+ *    silence, then EOT with the start address.
+ * ---------------------------------------------------------------- */
+static void send_image(FIL *fp, fastload_report_t *r, fastload_progress_t progress, void *ctx)
+{
+    uint32_t saved_baud = uart_bridge_get_baud();
+
+    if (!uart_bridge_tap_attach(&reply_tap, reply_storage, sizeof reply_storage))
+    {
+        fail(r, FASTLOAD_ERR_TAP);
+        return;
+    }
+
+    r->baud = uart_bridge_set_baud(FASTLOAD_CPU_HZ / bit_cycles());
+    uart_bridge_set_stop_bits(2);
+
+    uint64_t start = time_us_64();
+    drain_replies(FASTLOAD_SETTLE_MS); // the G echo, and the stub starting up
+    if (!resync())
+        fail(r, FASTLOAD_ERR_SYNC);
+
+    uint32_t done = 0;
+    while (!r->err && done < r->bytes)
+    {
+        UINT len = MIN(r->bytes - done, FASTLOAD_BLOCK);
+        uint16_t addr = r->load + done;
+
+        r->fr = f_read(fp, block, len, &len);
+        if (r->fr != FR_OK || len == 0)
+        {
+            fail(r, FASTLOAD_ERR_FILE);
+            break;
+        }
+
+        uint32_t timeout_ms = (len + 6) * 11 * 1000 / r->baud +
+                              len * FASTLOAD_CRC_CYCLES / (FASTLOAD_CPU_HZ / 1000) +
+                              FASTLOAD_SLACK_MS;
+        int tries = 0;
+        int reply;
+        while ((reply = send_block(addr, len, timeout_ms)) != ACK)
+        {
+            if (reply == NAK)
+                r->naks++;
+            else
+                r->timeouts++;
+            debug_printf("fastload: block $%04X %s\n", addr, reply == NAK ? "NAK" : "no answer");
+
+            if (++tries > FASTLOAD_RETRIES || !resync())
+            {
+                r->failed_addr = addr;
+                fail(r, FASTLOAD_ERR_BLOCK);
+                break;
+            }
+        }
+
+        done += len;
+        r->blocks++;
+        if (progress && !progress(ctx, done, r->bytes))
+            fail(r, FASTLOAD_ERR_CANCEL);
+    }
+
+    if (!r->err)
+    {
+        uart_bridge_putc(EOT);
+        uart_bridge_putc(r->load & 0xFF);
+        uart_bridge_putc(r->load >> 8);
+        if (wait_answer(3, FASTLOAD_SLACK_MS) != ACK)
+            fail(r, FASTLOAD_ERR_SYNC);
+    }
+    r->data_us = time_us_64() - start;
+
+    uart_bridge_tap_detach(&reply_tap);
+    uart_bridge_set_stop_bits(1);
+    uart_bridge_set_baud(saved_baud);
+}
+
+/* ----------------------------------------------------------------
+ *  fastload_run()
+ *  – load a .bin/.prg through the stub and start it.  The stub is
+ *    left running if this fails part way; reset the PAL.
+ * ---------------------------------------------------------------- */
+void fastload_run(const char *path, const char *file_name, fastload_report_t *r,
+                  fastload_progress_t progress, void *ctx)
+{
+    FIL fp;
+
+    memset(r, 0, sizeof *r);
+    r->stub_bytes = sizeof stub_code;
+
+    if (!fastload_supported(file_name))
+    {
+        fail(r, FASTLOAD_ERR_FORMAT);
+        return;
+    }
+
+    r->fr = sd_open_fast(&fp, path, FA_READ);
+    if (r->fr != FR_OK)
+    {
+        fail(r, FASTLOAD_ERR_FILE);
+        return;
+    }
+
+    r->load = ptp_bin_load_addr(file_name);
+    r->bytes = f_size(&fp);
+
+    const char *dot = strrchr(file_name, '.');
+    if (dot && !strcasecmp(dot, ".prg"))
+    {
+        uint8_t hdr[2];
+        UINT got;
+        r->fr = f_read(&fp, hdr, sizeof hdr, &got);
+        if (r->fr != FR_OK)
+            fail(r, FASTLOAD_ERR_FILE);
+        else if (got != sizeof hdr)
+            fail(r, FASTLOAD_ERR_FORMAT);
+        else
+        {
+            r->load = hdr[0] | hdr[1] << 8;
+            r->bytes -= sizeof hdr;
+        }
+    }
+
+    if (!r->err && r->bytes == 0)
+        fail(r, FASTLOAD_ERR_FORMAT);
+    if (!r->err && (r->load + r->bytes > 0x10000 ||
+                    overlaps(r->load, r->bytes, STUB_ZP_FIRST, STUB_ZP_END - STUB_ZP_FIRST)))
+        fail(r, FASTLOAD_ERR_RANGE);
+
+    if (!r->err)
+    {
+        size_t i = 0;
+        while (i < count_of(stub_sites) &&
+               overlaps(r->load, r->bytes, stub_sites[i], sizeof stub_code))
+            i++;
+        if (i == count_of(stub_sites))
+            fail(r, FASTLOAD_ERR_ROOM);
+        else
+            r->stub_addr = stub_sites[i];
+    }
+
+    if (!r->err)
+    {
+        debug_printf("fastload: %s $%04X+%lu, stub at $%04X\n", file_name, r->load,
+                     (unsigned long)r->bytes, r->stub_addr);
+        send_stub(r->stub_addr, r);
+        send_image(&fp, r, progress, ctx);
+    }
+
+    sd_close_fast(&fp);
+}
+
+const char *fastload_strerror(int err)
+{
+    switch (err)
+    {
+    case FASTLOAD_OK:
+        return "ok";
+    case FASTLOAD_ERR_FILE:
+        return "file error";
+    case FASTLOAD_ERR_FORMAT:
+        return "not .bin/.prg";
+    case FASTLOAD_ERR_RANGE:
+        return "bad load range";
+    case FASTLOAD_ERR_ROOM:
+        return "no room for stub";
+    case FASTLOAD_ERR_TAP:
+        return "no free tap";
+    case FASTLOAD_ERR_SYNC:
+        return "no answer";
+    case FASTLOAD_ERR_BLOCK:
+        return "block failed";
+    case FASTLOAD_ERR_CANCEL:
+        return "cancelled";
+    }
+    return "?";
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "sd-card/sd-card.h"
+
+    /* ----------------------------------------------------------------
+     *  Fast binary loader
+     *
+     *  A small receive stub goes up as paper tape through the monitor's
+     *  L command and is started with G.  From then on the image moves
+     *  as raw bytes at the stub's own bit rate:
+     *
+     *    SOH lo hi len data.. crc_hi crc_lo  -> ACK / NAK   (len 0 = 256)
+     *    EOT lo hi                           -> ACK, then JMP (hi lo)
+     *    anything else                       -> ACK
+     *
+     *  CRC is CRC‑16/XMODEM, checked by the stub over the RAM it wrote.
+     *  The KIM‑1's bit‑by‑bit echo of everything sent arrives ahead
+     *  of each answer and is skipped by count; the resync ENQ shows
+     *  whether the link echoes at all.
+     * ---------------------------------------------------------------- */
+
+#define FASTLOAD_BLOCK 256
+
+    enum
+    {
+        FASTLOAD_OK = 0,
+        FASTLOAD_ERR_FILE,    // open/read failed, see fr
+        FASTLOAD_ERR_FORMAT,  // not a .bin/.prg, or empty
+        FASTLOAD_ERR_RANGE,   // image runs past $FFFF or over the stub's zero page
+        FASTLOAD_ERR_ROOM,    // nowhere left to put the stub
+        FASTLOAD_ERR_TAP,     // no free bridge tap for the replies
+        FASTLOAD_ERR_SYNC,    // the stub never answered
+        FASTLOAD_ERR_BLOCK,   // a block kept failing
+        FASTLOAD_ERR_CANCEL,  // MENU pressed
+    };
+
+    typedef struct
+    {
+        uint16_t load;          // also where the program starts
+        uint32_t bytes;         // image size
+        uint16_t stub_addr;
+        uint32_t stub_bytes;    // stub size
+        uint32_t baud;          // binary link rate
+        uint32_t blocks;
+        uint32_t naks;          // blocks the stub rejected
+        uint32_t timeouts;      // blocks that got no answer
+        uint64_t stub_us;       // stub through the text path: the yardstick
+        uint64_t data_us;       // image through the binary path
+        uint16_t failed_addr;   // with FASTLOAD_ERR_BLOCK
+        int err;                // FASTLOAD_ERR_*
+        FRESULT fr;
+    } fastload_report_t;
+
+    /* Called after every block; return false to cancel. */
+    typedef bool (*fastload_progress_t)(void *ctx, uint32_t done, uint32_t total);
+
+    bool fastload_supported(const char *file_name);
+    void fastload_run(const char *path, const char *file_name, fastload_report_t *r,
+                      fastload_progress_t progress, void *ctx);
+    const char *fastload_strerror(int err);
+
+#ifdef __cplusplus
+}
+#endif
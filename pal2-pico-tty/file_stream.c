@@ -0,0 +1,73 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "file_stream.h"
+#include "debug.h"
+
+static void fill(file_stream_t *s, uint8_t half)
+{
+    UINT br = 0;
+
+    if (!s->src_eof)
+    {
+        s->err = f_read(s->fp, s->buf[half], STREAM_BLOCK_SIZE, &br);
+        if (s->err != FR_OK)
+        {
+            debug_printf("stream: f_read error %d\n", s->err);
+            br = 0;
+        }
+        if (br < STREAM_BLOCK_SIZE)
+            s->src_eof = true;
+    }
+    s->len[half] = br;
+}
+
+void file_stream_open(file_stream_t *s, FIL *fp)
+{
+    s->fp = fp;
+    s->cur = 0;
+    s->pos = 0;
+    s->src_eof = false;
+    s->err = FR_OK;
+    s->consumed = 0;
+
+    fill(s, 0);
+    s->next_ready = false;
+}
+
+/* Cheap when there is nothing to do; call it whenever the caller is
+ * about to wait anyway.                                             */
+void file_stream_prefetch(file_stream_t *s)
+{
+    if (!s->next_ready)
+    {
+        fill(s, s->cur ^ 1);
+        s->next_ready = true;
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  file_stream_getc()
+ *  – next byte of the file, or -1 at end of file / on error.
+ *    No line buffer, so lines of any length pass through intact.
+ * ---------------------------------------------------------------- */
+int file_stream_getc(file_stream_t *s)
+{
+    if (s->pos >= s->len[s->cur])
+    {
+        if (s->len[s->cur] < STREAM_BLOCK_SIZE)
+            return -1; // that was the short, final block
+
+        file_stream_prefetch(s); // nobody got round to it: block now
+        s->cur ^= 1;
+        s->pos = 0;
+        s->next_ready = false;
+
+        if (s->len[s->cur] == 0)
+            return -1;
+    }
+
+    s->consumed++;
+    return s->buf[s->cur][s->pos++];
+}
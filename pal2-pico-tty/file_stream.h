@@ -0,0 +1,34 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "sd-card/sd-card.h"
+
+#define STREAM_BLOCK_SIZE 512 // one sector; FatFs reads it straight into buf
+
+    /* Two block buffers: one is being handed out byte by byte while
+     * the other is refilled by file_stream_prefetch() during the
+     * pacer's waits, so the UART side never sits on an SD read.      */
+    typedef struct
+    {
+        FIL *fp;
+        uint8_t buf[2][STREAM_BLOCK_SIZE];
+        UINT len[2];      // valid bytes in each half
+        uint8_t cur;      // half being consumed
+        UINT pos;         // next byte in buf[cur]
+        bool next_ready;  // buf[cur ^ 1] holds the following block
+        bool src_eof;     // f_read has come up short
+        FRESULT err;
+        uint32_t consumed; // bytes handed out so far
+    } file_stream_t;
+
+    void file_stream_open(file_stream_t *s, FIL *fp);
+    int file_stream_getc(file_stream_t *s);
+    void file_stream_prefetch(file_stream_t *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,160 @@
+#include <string.h>
+
+#include "hex_records.h"
+
+static inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+/* n bytes of hex from s into b; false on a non‑hex digit */
+static bool get_bytes(const char *s, uint8_t *b, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        int hi = hex_value(s[2 * i]);
+        int lo = hex_value(s[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        b[i] = hi << 4 | lo;
+    }
+    return true;
+}
+
+void hex_parser_init(hex_parser_t *h)
+{
+    memset(h, 0, sizeof *h);
+}
+
+static int check_range(hex_data_t *out)
+{
+    return out->addr + out->len > 0x10000 ? HEX_ERR_RANGE : HEX_DATA;
+}
+
+/* :LLAAAATTDD..CC, CC = two's complement of the byte sum */
+static int parse_ihex(hex_parser_t *h, const char *s, size_t len, hex_data_t *out)
+{
+    uint8_t b[4 + 255 + 1];
+
+    if (len < 11 || !get_bytes(s + 1, b, 1))
+        return HEX_ERR_SYNTAX;
+
+    size_t n = 4 + b[0] + 1; // LL AAAA TT data CC
+    if (len < 1 + 2 * n || !get_bytes(s + 1, b, n))
+        return HEX_ERR_SYNTAX;
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += b[i];
+    if (sum != 0)
+        return HEX_ERR_SUM;
+
+    uint16_t addr = b[1] << 8 | b[2];
+    switch (b[3])
+    {
+    case 0x00:
+        out->addr = h->base + addr;
+        out->len = b[0];
+        memcpy(out->data, b + 4, b[0]);
+        h->records++;
+        return check_range(out);
+    case 0x01:
+        return HEX_END;
+    case 0x02:
+    case 0x04:
+        if (b[0] < 2) // b[4..5] would be the checksum and whatever follows
+            return HEX_ERR_SYNTAX;
+        h->base = (uint32_t)(b[4] << 8 | b[5]) << (b[3] == 0x02 ? 4 : 16);
+        return HEX_NONE;
+    default: // 03/05 start address: the monitor's G does that
+        return HEX_NONE;
+    }
+}
+
+/* STCCAA..DD..SS, SS = ones' complement of the byte sum from CC */
+static int parse_srec(hex_parser_t *h, const char *s, size_t len, hex_data_t *out)
+{
+    static const uint8_t addr_bytes[10] = {2, 2, 3, 4, 0, 2, 3, 4, 3, 2};
+    uint8_t b[1 + 255];
+
+    char t = s[1];
+    if (len < 4 || t < '0' || t > '9' || t == '4' || !get_bytes(s + 2, b, 1))
+        return HEX_ERR_SYNTAX;
+
+    size_t n = 1 + b[0]; // CC, then that many bytes
+    uint8_t na = addr_bytes[t - '0'];
+    if (b[0] < na + 1 || len < 2 + 2 * n || !get_bytes(s + 2, b, n))
+        return HEX_ERR_SYNTAX;
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += b[i];
+    if (sum != 0xFF)
+        return HEX_ERR_SUM;
+
+    switch (t)
+    {
+    case '1':
+    case '2':
+    case '3':
+        out->addr = 0;
+        for (int i = 0; i < na; i++)
+            out->addr = out->addr << 8 | b[1 + i];
+        out->len = b[0] - na - 1;
+        memcpy(out->data, b + 1 + na, out->len);
+        h->records++;
+        return check_range(out);
+    case '7':
+    case '8':
+    case '9':
+        return HEX_END;
+    default: // S0 header, S5/S6 counts
+        return HEX_NONE;
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  hex_parse_line()
+ *  – one line, without its CR/LF.  Leading white space and lines
+ *    that are neither ':' nor 'S' records are skipped.
+ * ---------------------------------------------------------------- */
+int hex_parse_line(hex_parser_t *h, const char *line, size_t len, hex_data_t *out)
+{
+    h->lines++;
+
+    while (len && (*line == ' ' || *line == '\t'))
+    {
+        line++;
+        len--;
+    }
+    while (len && (line[len - 1] == ' ' || line[len - 1] == '\t' || line[len - 1] == '\r'))
+        len--;
+
+    if (len == 0)
+        return HEX_NONE;
+    if (line[0] == ':')
+        return parse_ihex(h, line, len, out);
+    if (line[0] == 'S' || line[0] == 's')
+        return parse_srec(h, line, len, out);
+    return HEX_NONE;
+}
+
+const char *hex_strerror(int status)
+{
+    switch (status)
+    {
+    case HEX_ERR_SYNTAX:
+        return "bad record";
+    case HEX_ERR_SUM:
+        return "checksum";
+    case HEX_ERR_RANGE:
+        return "above $FFFF";
+    default:
+        return "ok";
+    }
+}
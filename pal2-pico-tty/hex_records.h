@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+    /* ----------------------------------------------------------------
+     *  Intel HEX and Motorola S‑record lines, one at a time.  Only
+     *  the state between lines (the Intel HEX upper address) is kept,
+     *  so an image of any size streams through a single line buffer.
+     *  No SDK headers, so tools/ builds it on the host too.
+     * ---------------------------------------------------------------- */
+
+#define HEX_LINE_MAX (1 + 2 + 4 + 2 + 2 * 255 + 2 + 8) // longest ':' or 'S' line + slack
+#define HEX_MAX_DATA 255
+
+    typedef struct
+    {
+        uint32_t addr;
+        uint8_t len;
+        uint8_t data[HEX_MAX_DATA];
+    } hex_data_t;
+
+    enum
+    {
+        HEX_NONE = 0,         // header, comment or blank: nothing to load
+        HEX_DATA,             // *out holds data
+        HEX_END,              // Intel 01 / S7‑S9 termination record
+        HEX_ERR_SYNTAX = -1,
+        HEX_ERR_SUM = -2,
+        HEX_ERR_RANGE = -3,   // data above $FFFF: the 6502 cannot hold it
+    };
+
+    typedef struct
+    {
+        uint32_t base;    // Intel 02/04 extended address
+        uint32_t lines;
+        uint32_t records; // data records seen
+    } hex_parser_t;
+
+    void hex_parser_init(hex_parser_t *h);
+    int hex_parse_line(hex_parser_t *h, const char *line, size_t len, hex_data_t *out);
+    const char *hex_strerror(int status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "pico/unique_id.h"
+
+    /* ----------------------------------------------------------------
+     *  Hardware discovery cache
+     *
+     *  What the last boot found out the slow way, kept in the last
+     *  flash sector: the OLED's I2C address, and Pico or Pico W with
+     *  the board it was probed on.  Callers verify each value with
+     *  one targeted probe and rediscover only on a mismatch, then
+     *  hand the result back with hw_cache_set_*().  hw_cache_flush()
+     *  rewrites the sector only if something changed, and runs only
+     *  at the end of boot.
+     * ---------------------------------------------------------------- */
+
+    enum
+    {
+        HW_BOARD_UNKNOWN = 0,
+        HW_BOARD_PICO,
+        HW_BOARD_PICO_W,
+    };
+
+    typedef struct
+    {
+        int8_t oled_addr;                // -1: none / not known
+        uint8_t board;                   // HW_BOARD_*
+        uint8_t board_gpio25;            // GPIO25 level the board probe saw
+        pico_unique_board_id_t board_id; // flash unique ID it was probed on
+    } hw_cache_t;
+
+    const hw_cache_t *hw_cache_get(void);
+    void hw_cache_set_oled(int addr);
+    void hw_cache_set_board(uint8_t board, bool gpio25, const pico_unique_board_id_t *id);
+    bool hw_cache_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,219 @@
+#include <string.h>
+
+#include "kim_ptp.h"
+
+static const char HEX[] = "0123456789ABCDEF";
+
+static inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20; // tapes punched on lower‑case terminals
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static inline char *put_hex8(char *p, uint8_t v)
+{
+    p[0] = HEX[v >> 4];
+    p[1] = HEX[v & 15];
+    return p + 2;
+}
+
+void ptp_parser_init(ptp_parser_t *p)
+{
+    memset(p, 0, sizeof *p);
+}
+
+/* One finished byte: k counts from 0 at LL.  Returns a status once
+ * the checksum's low byte is in.                                    */
+static int take_byte(ptp_parser_t *p, uint16_t k, uint8_t b)
+{
+    ptp_record_t *r = &p->rec;
+    uint16_t body = 3 + r->len; // LL AAAA DD..
+
+    if (k == 0)
+        r->len = b;
+    else if (k == 1)
+        r->addr = b << 8;
+    else if (k == 2)
+        r->addr |= b;
+    else if (k < body)
+        r->data[k - 3] = b;
+    else if (k == body)
+    {
+        p->given = b << 8;
+        return PTP_NONE;
+    }
+    else
+    {
+        p->given |= b;
+        p->in_record = false;
+
+        /* The monitor's end record repeats the count as its checksum */
+        if (p->given != p->sum && !(r->len == 0 && p->given == r->addr))
+        {
+            p->bad++;
+            return PTP_ERR_SUM;
+        }
+        if (r->len == 0)
+            return r->addr == p->records ? PTP_END : PTP_ERR_COUNT;
+
+        p->records++;
+        return PTP_RECORD;
+    }
+
+    p->sum += b;
+    return PTP_NONE;
+}
+
+/* ----------------------------------------------------------------
+ *  ptp_parse_char()
+ *  – feed the tape one character at a time.  Returns PTP_RECORD or
+ *    PTP_END when p->rec holds a checked record, an error when a
+ *    record is broken off or fails its checksum, else PTP_NONE.
+ *    Bit 7 is ignored so mark parity from the monitor is fine.
+ * ---------------------------------------------------------------- */
+int ptp_parse_char(ptp_parser_t *p, char c)
+{
+    c &= 0x7F;
+
+    if (!p->in_record)
+    {
+        if (c == ';')
+        {
+            p->in_record = true;
+            p->digits = 0;
+            p->sum = 0;
+        }
+        return PTP_NONE;
+    }
+
+    int v = hex_value(c);
+    if (v < 0)
+    {
+        p->bad++;
+        p->in_record = c == ';'; // resync on the next record
+        p->digits = 0;
+        p->sum = 0;
+        return PTP_ERR_HEX;
+    }
+
+    if ((p->digits++ & 1) == 0)
+    {
+        p->nibble = v;
+        return PTP_NONE;
+    }
+    return take_byte(p, p->digits / 2 - 1, p->nibble << 4 | v);
+}
+
+uint16_t ptp_checksum(const ptp_record_t *r)
+{
+    uint16_t sum = r->len + (r->addr >> 8) + (r->addr & 0xFF);
+    for (int i = 0; i < r->len; i++)
+        sum += r->data[i];
+    return sum;
+}
+
+/* ";LLAAAA..CCCC\r\n", the way the monitor punches it.  Returns the
+ * length; out needs PTP_LINE_MAX bytes.                            */
+size_t ptp_format(const ptp_record_t *r, char *out)
+{
+    uint16_t sum = ptp_checksum(r);
+    char *p = out;
+
+    *p++ = ';';
+    p = put_hex8(p, r->len);
+    p = put_hex8(p, r->addr >> 8);
+    p = put_hex8(p, r->addr & 0xFF);
+    for (int i = 0; i < r->len; i++)
+        p = put_hex8(p, r->data[i]);
+    p = put_hex8(p, sum >> 8);
+    p = put_hex8(p, sum & 0xFF);
+    *p++ = '\r';
+    *p++ = '\n';
+    return p - out;
+}
+
+void ptp_encoder_init(ptp_encoder_t *e, uint16_t addr, uint8_t rec_len)
+{
+    e->addr = addr;
+    e->fill = 0;
+    e->rec_len = rec_len ? rec_len : PTP_DUMP_BYTES;
+    e->records = 0;
+}
+
+static size_t flush_record(ptp_encoder_t *e, char *out)
+{
+    ptp_record_t r;
+
+    if (e->fill == 0)
+        return 0;
+
+    r.len = e->fill;
+    r.addr = e->addr;
+    memcpy(r.data, e->buf, e->fill);
+
+    e->addr += e->fill;
+    e->fill = 0;
+    e->records++;
+    return ptp_format(&r, out);
+}
+
+/* ----------------------------------------------------------------
+ *  ptp_encode_byte()
+ *  – add the next byte of a binary image.  Returns the length of the
+ *    record written to out (PTP_LINE_MAX) when one fills up, else 0.
+ *    Records never run past $FFFF.
+ * ---------------------------------------------------------------- */
+size_t ptp_encode_byte(ptp_encoder_t *e, uint8_t b, char *out)
+{
+    e->buf[e->fill++] = b;
+
+    if (e->fill == e->rec_len || (uint32_t)e->addr + e->fill == 0x10000)
+        return flush_record(e, out);
+    return 0;
+}
+
+/* Move on to addr.  Bytes that carry straight on from the last one
+ * keep filling the same record, so adjacent input records merge; a
+ * jump ends it.  Returns the length of that record in out, or 0.   */
+size_t ptp_encode_seek(ptp_encoder_t *e, uint16_t addr, char *out)
+{
+    size_t n = 0;
+
+    if (addr != (uint16_t)(e->addr + e->fill))
+    {
+        n = flush_record(e, out);
+        e->addr = addr;
+    }
+    return n;
+}
+
+/* The partial record, if any, then the end record; out needs
+ * 2 * PTP_LINE_MAX bytes.                                           */
+size_t ptp_encode_end(ptp_encoder_t *e, char *out)
+{
+    size_t n = flush_record(e, out);
+    ptp_record_t end = {.len = 0, .addr = (uint16_t)e->records};
+
+    return n + ptp_format(&end, out + n);
+}
+
+const char *ptp_strerror(int status)
+{
+    switch (status)
+    {
+    case PTP_ERR_HEX:
+        return "bad hex digit";
+    case PTP_ERR_SUM:
+        return "checksum";
+    case PTP_ERR_COUNT:
+        return "record count";
+    case PTP_ERR_ADDR:
+        return "address order";
+    default:
+        return "ok";
+    }
+}
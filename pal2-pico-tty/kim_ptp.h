@@ -0,0 +1,83 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+    /* ----------------------------------------------------------------
+     *  KIM‑1 paper tape
+     *
+     *  ;LLAAAADD..DDCCCC   LL data bytes loaded at AAAA; CCCC is the
+     *                      16‑bit sum of every byte on the line before it
+     *  ;00NNNNCCCC         end of tape after NNNN data records
+     *
+     *  Anything between records (CR LF, NUL padding, "KIM" prompts)
+     *  is ignored, as the monitor's L command does.  No SDK headers,
+     *  so tools/ builds the same code on the host.
+     * ---------------------------------------------------------------- */
+
+#define PTP_MAX_DATA 255
+#define PTP_DUMP_BYTES 24 // what the monitor's Q dump puts on a line
+#define PTP_MERGE_BYTES PTP_MAX_DATA // L takes any count; fewer lines, fewer line delays
+#define PTP_LINE_MAX (1 + 2 + 4 + 2 * PTP_MAX_DATA + 4 + 2)
+
+    typedef struct
+    {
+        uint8_t len;  // 0 for the end record
+        uint16_t addr; // end record: the record count
+        uint8_t data[PTP_MAX_DATA];
+    } ptp_record_t;
+
+    enum
+    {
+        PTP_NONE = 0,   // keep feeding
+        PTP_RECORD,     // a data record passed its checksum
+        PTP_END,        // the end record, count matches
+        PTP_ERR_HEX = -1,
+        PTP_ERR_SUM = -2,
+        PTP_ERR_COUNT = -3,
+        PTP_ERR_ADDR = -4, // records out of order (dump capture only)
+    };
+
+    typedef struct
+    {
+        ptp_record_t rec;
+        bool in_record;
+        uint16_t digits;   // hex digits taken since ';'
+        uint8_t nibble;    // high half of the byte being read
+        uint16_t sum;      // over the bytes read so far
+        uint16_t given;    // the checksum on the tape
+        uint32_t records;  // data records accepted
+        uint32_t bad;      // records rejected
+    } ptp_parser_t;
+
+    typedef struct
+    {
+        uint16_t addr; // where buf[0] loads
+        uint8_t buf[PTP_MAX_DATA];
+        uint8_t fill;
+        uint8_t rec_len;
+        uint32_t records;
+    } ptp_encoder_t;
+
+    void ptp_parser_init(ptp_parser_t *p);
+    int ptp_parse_char(ptp_parser_t *p, char c);
+
+    uint16_t ptp_checksum(const ptp_record_t *r);
+    size_t ptp_format(const ptp_record_t *r, char *out);
+
+    void ptp_encoder_init(ptp_encoder_t *e, uint16_t addr, uint8_t rec_len);
+    size_t ptp_encode_byte(ptp_encoder_t *e, uint8_t b, char *out);
+    size_t ptp_encode_seek(ptp_encoder_t *e, uint16_t addr, char *out);
+    size_t ptp_encode_end(ptp_encoder_t *e, char *out);
+
+    const char *ptp_strerror(int status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,291 @@
+#include <string.h>
+
+#include "kim_tape.h"
+
+static const char HEX[] = "0123456789ABCDEF";
+
+static inline uint8_t *put_hex8(uint8_t *p, uint8_t v)
+{
+    p[0] = HEX[v >> 4];
+    p[1] = HEX[v & 15];
+    return p + 2;
+}
+
+void kim_tape_encoder_init(kim_tape_encoder_t *e, uint8_t id, uint16_t addr)
+{
+    memset(e, 0, sizeof *e);
+    e->id = id;
+    e->addr = addr;
+}
+
+/* Leader, start character, ID and load address.  The ID stays out
+ * of the checksum, the address is in it, as the monitor's DUMPT has it. */
+size_t kim_tape_encode_begin(kim_tape_encoder_t *e, uint8_t *out)
+{
+    uint8_t *p = out;
+
+    memset(p, KIM_TAPE_SYN, KIM_TAPE_SYNC_CHARS);
+    p += KIM_TAPE_SYNC_CHARS;
+    *p++ = KIM_TAPE_START;
+    p = put_hex8(p, e->id);
+
+    e->sum = 0;
+    p = put_hex8(p, e->addr & 0xFF);
+    e->sum += e->addr & 0xFF;
+    p = put_hex8(p, e->addr >> 8);
+    e->sum += e->addr >> 8;
+
+    return p - out;
+}
+
+size_t kim_tape_encode_byte(kim_tape_encoder_t *e, uint8_t b, uint8_t *out)
+{
+    put_hex8(out, b);
+    e->sum += b;
+    e->bytes++;
+    return 2;
+}
+
+size_t kim_tape_encode_end(kim_tape_encoder_t *e, uint8_t *out)
+{
+    uint8_t *p = out;
+
+    *p++ = KIM_TAPE_END;
+    p = put_hex8(p, e->sum & 0xFF);
+    p = put_hex8(p, e->sum >> 8);
+    *p++ = KIM_TAPE_EOT;
+    *p++ = KIM_TAPE_EOT;
+
+    return p - out;
+}
+
+/* ----------------------------------------------------------------
+ *  kim_tape_bit_halves()
+ *  – one bit as alternating high/low half cycles, in units of
+ *    1/KIM_TAPE_UNIT_HZ, exactly as tape_out.pio times it: the last
+ *    high‑tone half picks up the tone switch, the last low‑tone half
+ *    the next bit's fetch (and the jump back after a 1).
+ * ---------------------------------------------------------------- */
+size_t kim_tape_bit_halves(int bit, uint16_t *out)
+{
+    int hi = bit ? 9 : 18;
+    int lo = bit ? 12 : 6;
+    size_t n = 0;
+
+    for (int i = 0; i < hi; i++)
+    {
+        out[n++] = KIM_TAPE_HI_HALF;
+        out[n++] = KIM_TAPE_HI_HALF;
+    }
+    out[n - 1] += 1; // set y
+
+    for (int i = 0; i < lo; i++)
+    {
+        out[n++] = KIM_TAPE_LO_HALF;
+        out[n++] = KIM_TAPE_LO_HALF;
+    }
+    out[n - 1] += 3 + (bit ? 1 : 0); // out, jmp !x, set y (+ jmp bit)
+
+    return n;
+}
+
+enum
+{
+    D_HUNT,   // looking for a SYN on any bit boundary
+    D_LEADER, // framed, reading SYNs until '*'
+    D_HEADER, // ID SAL SAH
+    D_DATA,
+    D_CHECK,  // CHKL CHKH
+};
+
+void kim_tape_decoder_init(kim_tape_decoder_t *d)
+{
+    memset(d, 0, sizeof *d);
+    d->state = D_HUNT;
+}
+
+bool kim_tape_in_record(const kim_tape_decoder_t *d)
+{
+    return d->state >= D_HEADER;
+}
+
+/* Drop framing; inside a record that is an error. */
+static int lose(kim_tape_decoder_t *d, int err)
+{
+    bool was = kim_tape_in_record(d);
+    d->state = D_HUNT;
+    d->have_nibble = false;
+    return was ? err : KIM_TAPE_EV_NONE;
+}
+
+static int hex_val(uint8_t c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static int take_byte(kim_tape_decoder_t *d, uint8_t b)
+{
+    switch (d->state)
+    {
+    case D_HEADER:
+        if (d->field == 0)
+            d->id = b;
+        else
+        {
+            d->sum += b;
+            if (d->field == 1)
+                d->addr = b;
+            else
+                d->addr |= b << 8;
+        }
+        if (++d->field < 3)
+            return KIM_TAPE_EV_NONE;
+        d->state = D_DATA;
+        return KIM_TAPE_EV_HEADER;
+
+    case D_DATA:
+        d->sum += b;
+        d->bytes++;
+        d->data = b;
+        return KIM_TAPE_EV_DATA;
+
+    default: // D_CHECK
+        if (d->field++ == 0)
+        {
+            d->chk = b;
+            return KIM_TAPE_EV_NONE;
+        }
+        d->chk |= b << 8;
+        d->state = D_HUNT;
+        return d->chk == d->sum ? KIM_TAPE_EV_END : KIM_TAPE_ERR_CHECKSUM;
+    }
+}
+
+static int take_char(kim_tape_decoder_t *d, uint8_t c)
+{
+    d->chars++;
+
+    if (d->state == D_LEADER)
+    {
+        if (c == KIM_TAPE_SYN)
+        {
+            d->syn++;
+        }
+        else if (c == KIM_TAPE_START && d->syn >= KIM_TAPE_SYNC_MIN)
+        {
+            d->state = D_HEADER;
+            d->field = 0;
+            d->have_nibble = false;
+            d->sum = 0;
+            d->bytes = 0;
+        }
+        else
+        {
+            d->state = D_HUNT;
+        }
+        return KIM_TAPE_EV_NONE;
+    }
+
+    if (d->state == D_DATA && c == KIM_TAPE_END && !d->have_nibble)
+    {
+        d->state = D_CHECK;
+        d->field = 0;
+        return KIM_TAPE_EV_NONE;
+    }
+
+    int v = hex_val(c);
+    if (v < 0)
+        return lose(d, KIM_TAPE_ERR_FORMAT);
+    if (!d->have_nibble)
+    {
+        d->nibble = v;
+        d->have_nibble = true;
+        return KIM_TAPE_EV_NONE;
+    }
+    d->have_nibble = false;
+    return take_byte(d, d->nibble << 4 | v);
+}
+
+static int take_bit(kim_tape_decoder_t *d, int bit)
+{
+    d->bits++;
+    d->shift = (d->shift >> 1) | (bit << 7);
+
+    if (d->state == D_HUNT)
+    {
+        if (d->shift == KIM_TAPE_SYN)
+        {
+            d->state = D_LEADER;
+            d->nbits = 0;
+            d->syn = 1;
+        }
+        return KIM_TAPE_EV_NONE;
+    }
+
+    if (++d->nbits < 8)
+        return KIM_TAPE_EV_NONE;
+    d->nbits = 0;
+    return take_char(d, d->shift);
+}
+
+/* ----------------------------------------------------------------
+ *  kim_tape_decode_half()
+ *  – take one half cycle; returns KIM_TAPE_EV_NONE, an event, or a
+ *    KIM_TAPE_ERR_* once a record has gone bad (the decoder is then
+ *    back to hunting for the next leader).  At most one per call.
+ * ---------------------------------------------------------------- */
+int kim_tape_decode_half(kim_tape_decoder_t *d, uint32_t us)
+{
+    if (us < KIM_TAPE_GLITCH_US)
+        return KIM_TAPE_EV_NONE;
+
+    if (us > KIM_TAPE_GAP_US)
+    {
+        d->hi_us = d->lo_us = 0;
+        return lose(d, KIM_TAPE_ERR_SIGNAL);
+    }
+
+    if (us >= KIM_TAPE_SPLIT_US)
+    {
+        d->lo_us += us;
+        return KIM_TAPE_EV_NONE;
+    }
+
+    if (d->lo_us == 0)
+    {
+        d->hi_us += us;
+        return KIM_TAPE_EV_NONE;
+    }
+
+    /* low -> high: the bit in hand is complete */
+    uint32_t len = d->hi_us + d->lo_us;
+    int bit = d->lo_us > d->hi_us;
+    bool whole = d->hi_us != 0; // not the tail end of one we joined late
+    d->hi_us = us;
+    d->lo_us = 0;
+
+    if (!whole)
+        return KIM_TAPE_EV_NONE;
+    if (len < KIM_TAPE_BIT_MIN_US || len > KIM_TAPE_BIT_MAX_US)
+        return lose(d, KIM_TAPE_ERR_SIGNAL);
+    return take_bit(d, bit);
+}
+
+const char *kim_tape_strerror(int err)
+{
+    switch (err)
+    {
+    case KIM_TAPE_ERR_CHECKSUM:
+        return "checksum";
+    case KIM_TAPE_ERR_FORMAT:
+        return "bad character";
+    case KIM_TAPE_ERR_SIGNAL:
+        return "signal lost";
+    default:
+        return err < 0 ? "?" : "ok";
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+    /* ----------------------------------------------------------------
+     *  KIM‑1 audio cassette
+     *
+     *  100 x SYN  '*'  ID  SAL SAH  DD..DD  '/'  CHKL CHKH  EOT EOT
+     *
+     *  Every byte after '*' goes as two ASCII hex characters, high
+     *  nibble first; CHK is the 16‑bit sum of SAL, SAH and the data.
+     *  Characters go out 8 bits LSB first.  Each bit starts in the
+     *  high tone and ends in the low one; where it changes says 0/1:
+     *
+     *    0:  18 cycles of 3700 Hz, then  6 of 2400 Hz
+     *    1:   9 cycles of 3700 Hz, then 12 of 2400 Hz
+     *
+     *  No SDK headers, so tools/ builds the same code on the host.
+     * ---------------------------------------------------------------- */
+
+#define KIM_TAPE_SYNC_CHARS 100
+#define KIM_TAPE_SYN 0x16
+#define KIM_TAPE_START '*'
+#define KIM_TAPE_END '/'
+#define KIM_TAPE_EOT 0x04
+
+#define KIM_TAPE_HI_HZ 3700
+#define KIM_TAPE_LO_HZ 2400
+
+    /* Timing as tape_out.pio plays it, in units of 1/KIM_TAPE_UNIT_HZ:
+     * 24 units a half cycle at 3700 Hz, 37 at 2400 Hz (2402 Hz).      */
+#define KIM_TAPE_HI_HALF 24
+#define KIM_TAPE_LO_HALF 37
+#define KIM_TAPE_UNIT_HZ (2 * KIM_TAPE_HI_HZ * KIM_TAPE_HI_HALF)
+#define KIM_TAPE_BIT_HALVES_MAX (2 * (18 + 6))
+
+#define KIM_TAPE_HEAD_MAX (KIM_TAPE_SYNC_CHARS + 1 + 2 + 4) // SYN.. * ID SAL SAH
+#define KIM_TAPE_TAIL_MAX (1 + 4 + 2)                       // / CHKL CHKH EOT EOT
+
+    typedef struct
+    {
+        uint8_t id;
+        uint16_t addr;
+        uint16_t sum;
+        uint32_t bytes;
+    } kim_tape_encoder_t;
+
+    void kim_tape_encoder_init(kim_tape_encoder_t *e, uint8_t id, uint16_t addr);
+    size_t kim_tape_encode_begin(kim_tape_encoder_t *e, uint8_t *out);
+    size_t kim_tape_encode_byte(kim_tape_encoder_t *e, uint8_t b, uint8_t *out);
+    size_t kim_tape_encode_end(kim_tape_encoder_t *e, uint8_t *out);
+
+    size_t kim_tape_bit_halves(int bit, uint16_t *out);
+
+    /* ----------------------------------------------------------------
+     *  Decoder: fed the length of every half cycle off the tape, in
+     *  microseconds.  Halves shorter than KIM_TAPE_SPLIT_US are the
+     *  high tone; a bit ends where the low tone gives way to the high
+     *  one, and is a 1 if it spent longer in the low tone.  Framing
+     *  comes from the leader: the first SYN on any bit boundary sets
+     *  it, and KIM_TAPE_SYNC_MIN of them before '*' start a record.
+     * ---------------------------------------------------------------- */
+
+#define KIM_TAPE_SPLIT_US 170   // 135 us high, 208 us low
+#define KIM_TAPE_GLITCH_US 40   // shorter halves are ignored
+#define KIM_TAPE_GAP_US 1000    // longer ones mean the signal is gone
+#define KIM_TAPE_BIT_MIN_US 5000 // a bit is 7.3..7.5 ms
+#define KIM_TAPE_BIT_MAX_US 10000
+#define KIM_TAPE_SYNC_MIN 4
+
+    enum
+    {
+        KIM_TAPE_EV_NONE = 0,
+        KIM_TAPE_EV_HEADER,      // id and addr are in
+        KIM_TAPE_EV_DATA,        // data holds the next byte
+        KIM_TAPE_EV_END,         // checksum matched; record complete
+        KIM_TAPE_ERR_CHECKSUM = -1,
+        KIM_TAPE_ERR_FORMAT = -2, // not a hex digit inside a record
+        KIM_TAPE_ERR_SIGNAL = -3, // dropout or a bit of the wrong length
+    };
+
+    typedef struct
+    {
+        uint32_t hi_us, lo_us; // of the bit in progress
+        uint8_t shift;         // the last 8 bits, newest in bit 7
+        uint8_t nbits;         // into the current character
+        uint8_t syn;           // SYNs in a row
+        int state;
+        bool have_nibble;
+        uint8_t nibble;
+        uint8_t field;         // header/checksum bytes so far
+        uint8_t id;
+        uint16_t addr;
+        uint16_t sum;          // over SAL, SAH and the data so far
+        uint16_t chk;          // as read off the tape
+        uint32_t bytes;        // data bytes in this record
+        uint8_t data;
+        uint32_t bits, chars;  // totals, for diagnostics
+    } kim_tape_decoder_t;
+
+    void kim_tape_decoder_init(kim_tape_decoder_t *d);
+    int kim_tape_decode_half(kim_tape_decoder_t *d, uint32_t us);
+    bool kim_tape_in_record(const kim_tape_decoder_t *d);
+    const char *kim_tape_strerror(int err);
+
+#ifdef __cplusplus
+}
+#endif
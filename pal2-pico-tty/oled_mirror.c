@@ -0,0 +1,143 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "oled_mirror.h"
+#include "uart_bridge.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define MIRROR_TAP_SIZE 1024                // ~90 ms of 115200 baud
+#define MIRROR_REFRESH_US (40 * 1000)       // at most 25 redraws a second
+#define MIRROR_TAB_WIDTH 8
+
+static uint8_t mirror_storage[MIRROR_TAP_SIZE];
+static bridge_tap_t mirror_tap;
+static bool enabled;
+static bool pending;    // cells changed since the last redraw
+static uint64_t next_draw_us;
+static uint32_t reported_drops;
+
+static void flush_tap(void)
+{
+    uint8_t c;
+    while (spsc_ring_pop(&mirror_tap.ring, &c))
+        ;
+}
+
+/* ----------------------------------------------------------------
+ *  feed()
+ *  – one byte of PAL output into the terminal.  The KIM‑1 monitor
+ *    pads CR LF with NULs and RUBOUTs for a real Teletype and may
+ *    send mark parity, so bit 7 is dropped and padding skipped.
+ *    Returns true when a cell or the cursor moved.
+ * ---------------------------------------------------------------- */
+static bool feed(ssd1306_tty_t *tty, uint8_t c)
+{
+    c &= 0x7F;
+
+    switch (c)
+    {
+    case '\r':
+        tty->x = 0;
+        return true;
+    case '\n':
+        ssd1306_tty_writechar(tty, '\n');
+        return true;
+    case '\b':
+        if (tty->x > 0)
+            tty->x--;
+        return true;
+    case '\t':
+        do
+        {
+            ssd1306_tty_writechar(tty, ' ');
+        } while (tty->x % MIRROR_TAB_WIDTH && tty->x < tty->width);
+        return true;
+    default:
+        if (c < ' ' || c == 0x7F) // NUL / RUBOUT padding, BEL, ...
+            return false;
+        ssd1306_tty_writechar(tty, c);
+        return true;
+    }
+}
+
+void oled_mirror_set(ssd1306_tty_t *tty, bool on)
+{
+    if (on == enabled)
+        return;
+
+    if (on)
+    {
+        if (!uart_bridge_tap_attach(&mirror_tap, mirror_storage, sizeof mirror_storage))
+        {
+            debug_printf("mirror: no free tap\n");
+            return;
+        }
+        reported_drops = 0;
+        enabled = true;
+        oled_mirror_resume(tty);
+    }
+    else
+    {
+        uart_bridge_tap_detach(&mirror_tap);
+        enabled = false;
+    }
+}
+
+bool oled_mirror_enabled(void)
+{
+    return enabled;
+}
+
+/* The menu has drawn over the terminal and the tap has overflowed
+ * meanwhile; start again from a blank screen at the current byte. */
+void oled_mirror_resume(ssd1306_tty_t *tty)
+{
+    if (!enabled)
+        return;
+
+    flush_tap();
+    ssd1306_tty_set_scale(tty, 1);
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_show(tty);
+    pending = false;
+    next_draw_us = time_us_64() + MIRROR_REFRESH_US;
+}
+
+/* ----------------------------------------------------------------
+ *  oled_mirror_poll()
+ *  – drain the tap into the terminal, then redraw if anything
+ *    changed, the refresh interval is up and the last frame has
+ *    left the bus.  Bytes arriving in between only touch the cell
+ *    buffer, so a burst costs one frame however long it is.
+ * ---------------------------------------------------------------- */
+void oled_mirror_poll(ssd1306_tty_t *tty)
+{
+    uint8_t c;
+
+    if (!enabled)
+        return;
+
+    while (spsc_ring_pop(&mirror_tap.ring, &c))
+    {
+        if (feed(tty, c))
+            pending = true;
+    }
+
+    if (mirror_tap.dropped != reported_drops)
+    {
+        reported_drops = mirror_tap.dropped;
+        debug_printf("mirror: %lu bytes dropped\n", (unsigned long)reported_drops);
+    }
+
+    uint64_t now = time_us_64();
+    if (pending && now >= next_draw_us && !ssd1306_busy(tty->ssd1306))
+    {
+        ssd1306_tty_show(tty);
+        pending = false;
+        next_draw_us = now + MIRROR_REFRESH_US;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+    /* Live copy of the PAL->USB traffic on the OLED.  Bytes come off a
+     * bridge tap, so core 1 never waits on the display: when the tap
+     * fills up the mirror loses bytes, the link does not.            */
+    void oled_mirror_set(ssd1306_tty_t *tty, bool on);
+    bool oled_mirror_enabled(void);
+    void oled_mirror_resume(ssd1306_tty_t *tty);
+    void oled_mirror_poll(ssd1306_tty_t *tty);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,188 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "pacer.h"
+#include "uart_bridge.h"
+#include "pal_baud.h"
+#include "proj_hw.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define ECHO_TAP_SIZE 256
+#define ECHO_CHAR_TIMES 3  // never time out before this many char times
+
+static uint8_t echo_storage[ECHO_TAP_SIZE];
+static bridge_tap_t echo_tap;
+
+/* 10 bits per char on the wire; the KIM‑1 echoes bit by bit, so the
+ * echo finishes roughly one char time after the byte leaves us.     */
+static uint32_t char_time_ms(void)
+{
+    uint32_t baud = uart_bridge_get_baud();
+    return (10 * 1000 + baud - 1) / baud;
+}
+
+static void flush_echo(void)
+{
+    uint8_t c;
+    while (spsc_ring_pop(&echo_tap.ring, &c))
+        ;
+}
+
+static inline void run_idle(pacer_t *p)
+{
+    if (p->idle)
+        p->idle(p->idle_ctx);
+}
+
+static void wait_ms(pacer_t *p, uint32_t ms)
+{
+    absolute_time_t until = make_timeout_time_ms(ms);
+
+    run_idle(p);
+    while (!time_reached(until))
+    {
+        tight_loop_contents();
+    }
+}
+
+static bool wait_for_echo(pacer_t *p, uint32_t timeout_ms)
+{
+    absolute_time_t until = make_timeout_time_ms(timeout_ms);
+    uint8_t c;
+
+    run_idle(p);
+    while (!spsc_ring_pop(&echo_tap.ring, &c))
+    {
+        if (time_reached(until))
+            return false;
+        tight_loop_contents();
+    }
+    return true;
+}
+
+/* After CR the monitor (or BASIC) is busy with the line and not
+ * listening; wait until it has stopped talking, capped at limit_ms.  */
+static void wait_for_quiet(uint32_t quiet_ms, uint32_t limit_ms)
+{
+    absolute_time_t limit = make_timeout_time_ms(limit_ms);
+    absolute_time_t quiet = make_timeout_time_ms(quiet_ms);
+    uint8_t c;
+
+    while (!time_reached(quiet) && !time_reached(limit))
+    {
+        if (spsc_ring_pop(&echo_tap.ring, &c))
+        {
+            quiet = make_timeout_time_ms(quiet_ms);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  pacer_begin()
+ *  – a cfg.baud other than the current rate goes through
+ *    pal_baud_sync(), so it resets the PAL.  If the PAL doesn't come
+ *    up at the new rate it is synced back to the old one.  Either way
+ *    the link stays where it ends up after the transfer, just as
+ *    PAL BAUD leaves it: moving back would cost another reset.
+ * ---------------------------------------------------------------- */
+void pacer_begin(pacer_t *p, const pace_config_t *cfg)
+{
+    p->cfg = *cfg;
+    memset(&p->report, 0, sizeof p->report);
+
+    uint32_t was = uart_bridge_get_baud();
+    if (p->cfg.baud && p->cfg.baud != was)
+    {
+        pal_baud_sync_t sync;
+        if (!pal_baud_sync(p->cfg.baud, &sync))
+        {
+            debug_printf("pacer: PAL not at %lu, back to %lu\n", (unsigned long)p->cfg.baud,
+                         (unsigned long)was);
+            pal_baud_sync(was, &sync);
+            p->report.baud_failed = true;
+        }
+    }
+    p->report.baud = uart_bridge_get_baud();
+
+    if (p->cfg.echo_wait && !uart_bridge_tap_attach(&echo_tap, echo_storage, sizeof echo_storage))
+    {
+        debug_printf("pacer: no free tap, falling back to fixed delays\n");
+        p->cfg.echo_wait = false;
+    }
+
+    p->idle = NULL;
+    p->idle_ctx = NULL;
+    p->start_us = time_us_64();
+}
+
+void pacer_set_idle(pacer_t *p, void (*idle)(void *ctx), void *ctx)
+{
+    p->idle = idle;
+    p->idle_ctx = ctx;
+}
+
+/* ----------------------------------------------------------------
+ *  pacer_send()
+ *  – queue one byte for the PAL and hold until it is safe to send
+ *    the next: its echo (plus a quiet line after CR/LF), or the
+ *    fixed delay when no echo turns up.
+ * ---------------------------------------------------------------- */
+void pacer_send(pacer_t *p, uint8_t c)
+{
+    bool eol = c == '\r' || c == '\n';
+    uint32_t delay_ms = eol ? p->cfg.line_delay_ms : p->cfg.char_delay_ms;
+
+    p->report.bytes++;
+    if (eol)
+        p->report.lines++;
+
+    if (!p->cfg.echo_wait)
+    {
+        uart_bridge_putc(c);
+        wait_ms(p, delay_ms);
+        return;
+    }
+
+    flush_echo(); // a late echo from the last byte must not release this one
+    uart_bridge_putc(c);
+
+    uint32_t timeout_ms = MAX(delay_ms, ECHO_CHAR_TIMES * char_time_ms());
+    if (wait_for_echo(p, timeout_ms))
+    {
+        p->report.echoed++;
+        if (eol)
+        {
+            wait_for_quiet(p->cfg.line_quiet_ms, timeout_ms);
+        }
+    }
+    else
+    {
+        p->report.timeouts++;
+    }
+}
+
+void pacer_end(pacer_t *p)
+{
+    while (!uart_bridge_tx_idle())
+    {
+        tight_loop_contents();
+    }
+
+    if (p->cfg.echo_wait)
+    {
+        uart_bridge_tap_detach(&echo_tap);
+        if (echo_tap.dropped)
+            debug_printf("pacer: %lu echo bytes dropped\n", (unsigned long)echo_tap.dropped);
+    }
+
+    p->report.elapsed_us = time_us_64() - p->start_us;
+
+    debug_printf("Sent %lu bytes, %lu lines at %lu baud in %lu ms (echo %lu, timeout %lu)\n",
+                 (unsigned long)p->report.bytes, (unsigned long)p->report.lines,
+                 (unsigned long)p->report.baud, (unsigned long)(p->report.elapsed_us / 1000),
+                 (unsigned long)p->report.echoed, (unsigned long)p->report.timeouts);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+
+    typedef struct
+    {
+        uint32_t baud;          // PAL link rate, 0 = leave as is; else a PAL reset + resync
+        uint32_t char_delay_ms; // per‑char delay, or echo timeout when echo_wait
+        uint32_t line_delay_ms; // after CR/LF, or line settle cap when echo_wait
+        bool echo_wait;         // release the next byte as soon as the PAL echoes
+        uint32_t line_quiet_ms; // with echo_wait: silence that ends a line
+    } pace_config_t;
+
+    typedef struct
+    {
+        uint32_t bytes;
+        uint32_t lines;
+        uint32_t echoed;     // bytes released by their echo
+        uint32_t timeouts;   // bytes released by the fallback delay
+        uint32_t baud;       // link rate the transfer ran at
+        bool baud_failed;    // the PAL didn't follow cfg.baud; ran at the old rate
+        uint64_t elapsed_us;
+    } transfer_report_t;
+
+    typedef struct
+    {
+        pace_config_t cfg;
+        transfer_report_t report;
+        uint64_t start_us;
+        void (*idle)(void *ctx); // run while waiting, e.g. to refill buffers
+        void *idle_ctx;
+    } pacer_t;
+
+    void pacer_begin(pacer_t *p, const pace_config_t *cfg);
+    void pacer_set_idle(pacer_t *p, void (*idle)(void *ctx), void *ctx);
+    void pacer_send(pacer_t *p, uint8_t c);
+    void pacer_end(pacer_t *p);
+
+#ifdef __cplusplus
+}
+#endif
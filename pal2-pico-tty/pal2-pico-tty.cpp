@@ -19,12 +19,22 @@
 #include "ssd1306.h"
 #include "proj_hw.h"
 #include "tty_switch_passthrough.h"
+#include "uart_bridge.h"
+#include "oled_mirror.h"
+#include "recorder.h"
+#include "session_log.h"
+#include "deck.h"
+#include "boot.h"
+#include "hw_cache.h"
 #include "debug.h"
 
-#define USB_TIMEOUT_US (1 * 1000000)
+#define DECK_DRAW_US (250 * 1000) // tape counter refresh while PLAY runs
 
-static void reset_pal(void);
 void main_loop(ssd1306_tty_t *tty);
+void show_default_text(ssd1306_tty_t *tty);
+
+static ssd1306_t disp;
+static ssd1306_tty_t tty;
 
 void blink_pin_forever(PIO pio, uint sm, uint offset, uint pin, uint freq)
 {
@@ -38,39 +48,73 @@ void blink_pin_forever(PIO pio, uint sm, uint offset, uint pin, uint freq)
     pio->txf[sm] = (125000000 / (2 * freq)) - 3;
 }
 
-static void wait_for_usb_with_timeout()
+/* ----------------------------------------------------------------
+ *  Deferred boot work, run by boot_step() from the main loop while
+ *  core 1 is already forwarding.  The SD card is mounted on first
+ *  use (menu, RECORD) and the free heap is measured by ABOUT.
+ * ---------------------------------------------------------------- */
+static void boot_display(void)
 {
-    uint64_t start_time = time_us_64();
-    while (!stdio_usb_connected())
+    debug_printf("Finding the OLED\r\n");
+    int i2c_addr = find_oled();
+    if (i2c_addr >= 0)
     {
-        if (time_us_64() - start_time >= USB_TIMEOUT_US)
-        {
-            break;
-        }
-        tight_loop_contents();
+        debug_printf("First I²C device @ 0x%02X\r\n", i2c_addr);
     }
+    else
+    {
+        debug_printf("No I²C devices detected\r\n");
+    }
+
+    init_ssd1306(i2c_addr, &disp);
+    ssd1306_init_tty(&disp, &tty, font_8x5);
+    show_default_text(&tty);
 }
 
-int main()
+static void boot_pal(void)
 {
-    stdio_init_all();
-
-    wait_for_usb_with_timeout();
+    reset_pal_release();
+}
 
+static void boot_board(void)
+{
     configure_hardware();
 
-    init_buttons();
+    // Example to turn on the Pico W LED
+    cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
+
+    hw_cache_flush(); // last of the boot probes; a no‑op unless one found something new
+}
+
+enum
+{
+    BOOT_DISPLAY,
+    BOOT_PAL,
+    BOOT_BOARD,
+};
+
+/* Table order is priority: the display first, so the UI is up while
+ * the PAL is still held in reset.                                  */
+static boot_task_t boot_tasks[] = {
+    {"display", 0, boot_display, false}, // BOOT_DISPLAY
+    {"pal", 0, boot_pal, false},         // BOOT_PAL: PAL_RESET_MS after main() asserts it
+    {"board", 0, boot_board, false},     // BOOT_BOARD: BOARD_SETTLE_MS after the probe starts
+};
+
+int main()
+{
+    boot_mark("main");
+    stdio_init_all();
+    boot_mark("stdio");
 
-    // // Initialise the Wi-Fi chip
-    // if (cyw43_arch_init()) {
-    //     printf("Wi-Fi init failed\n");
-    //     return -1;
-    // }
+    init_buttons();
 
     /* --- UART setup ------------------------------------------------------ */
     uart_init(PAL_UART, BAUD_RATE);
     gpio_set_function(PAL_UART_TX_GPIO, GPIO_FUNC_UART);
     gpio_set_function(PAL_UART_RX_GPIO, GPIO_FUNC_UART);
+    uart_bridge_init();
+    boot_mark("bridge");
 
     // SPI initialisation. This example will use SPI at 1MHz.
     spi_init(SPI_PORT, 1000 * 1000);
@@ -102,106 +146,193 @@ int main()
 #endif
     // For more pio examples see https://github.com/raspberrypi/pico-examples/tree/master/pio
 
-    // Example to turn on the Pico W LED
-    cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
-
-    // Set the TX and RX pins by using the function select on the GPIO
-    // Set datasheet for more information on function select
-    gpio_set_function(PAL_UART_TX_GPIO, GPIO_FUNC_UART);
-    gpio_set_function(PAL_UART_RX_GPIO, GPIO_FUNC_UART);
+    switch_passthrough_init(); // leaves PAL_RESET_GPIO an input: assert after
 
-    // Use some the various UART functions to send out data
-    // In a default system, printf will also output via the default UART
+    /* The PAL boots while the rest comes up rather than after it. */
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    reset_pal_assert();
+    boot_tasks[BOOT_PAL].not_before_ms = now_ms + PAL_RESET_MS;
+    bool settled = configure_hardware_begin(); // true: board type cached
+    boot_tasks[BOOT_BOARD].not_before_ms = settled ? now_ms : now_ms + BOARD_SETTLE_MS;
 
-    // Send out a string, with CR/LF conversions
-    // uart_puts(PAL_UART, " Hello, UART!\n");
-
-    // For more examples of UART use see https://github.com/raspberrypi/pico-examples/tree/master/uart
+    main_loop(&tty);
+}
 
-    debug_printf("Scanning I²C\r\n");
-    int i2c_addr = scan_i2c_bus();
-    if (i2c_addr >= 0)
+void show_default_text(ssd1306_tty_t *tty)
+{
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_puts(tty, " TTY MODE\n");
+    ssd1306_tty_puts(tty, " USB<->PAL2\n");
+    // ssd1306_tty_puts(tty, " \n");
+    // ssd1306_tty_puts(tty, " MENU FOR MENU");
+    if (recorder_active())
     {
-        debug_printf("First I²C device @ 0x%02X\r\n", i2c_addr);
+        ssd1306_tty_printf(tty, " REC %s\n", recorder_path() + 3); // skip "0:/"
     }
-    else
+    if (session_log_active())
     {
-        debug_printf("No I²C devices detected\r\n");
+        ssd1306_tty_printf(tty, " LOG %s\n", session_log_path() + 3);
     }
+    if (deck_loaded())
+    {
+        const deck_status_t *st = deck_status();
+        ssd1306_tty_printf(tty, " TAPE %s\n", st->name);
+        ssd1306_tty_printf(tty, " %s %lu/%lu\n", st->recording ? "REC" : "rec",
+                           (unsigned long)MIN(st->record + 1, st->records), (unsigned long)st->records);
+    }
+    ssd1306_tty_show(tty);
+}
 
-    ssd1306_t disp;
-    ssd1306_tty_t tty;
-
-    init_ssd1306(i2c_addr, &disp);
-    ssd1306_init_tty(&disp, &tty, font_8x5);
-
-    ssd1306_tty_puts(&tty, "SCANNING DRIVE --");
-    ssd1306_tty_show(&tty);
-    debug_printf("Scanning drive\r\n");
-    int k = prep_sd_card();
-    debug_printf("Done scanning drive\r\n");
-
-    ssd1306_tty_puts(&tty, "Done\n");
-    ssd1306_tty_show(&tty);
-
-    ssd1306_tty_puts(&tty, "Scanning RAM");
-    ssd1306_tty_show(&tty);
-    size_t mem_size1 = get_largest_alloc_block_binary2(1, 1024 * 1024);
-    size_t freeK = (size_t)(mem_size1 / 1024);
-
-    debug_printf("(binary) Largest chunk of free heap = %d %d\r\n", mem_size1, freeK);
+static void show_idle_screen(ssd1306_tty_t *tty)
+{
+    if (oled_mirror_enabled())
+        oled_mirror_resume(tty);
+    else
+        show_default_text(tty);
+}
 
-    int y = 0;
-    int ss = 1;
+/* ----------------------------------------------------------------
+ *  show_record_report()
+ *  – what the recording that just stopped captured, and how close
+ *    the ring came to overflowing.  Any button leaves.
+ * ---------------------------------------------------------------- */
+static void show_record_report(ssd1306_tty_t *tty, const record_report_t *r)
+{
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s\n", r->path + 3);
+    ssd1306_tty_printf(tty, "%luB in %lus\n",
+                       (unsigned long)r->bytes, (unsigned long)(r->elapsed_us / 1000000));
+    ssd1306_tty_printf(tty, "dropped %lu\n", (unsigned long)r->dropped);
+    ssd1306_tty_printf(tty, "peak %lu/%luK\n",
+                       (unsigned long)r->peak, (unsigned long)(r->ring_size / 1024));
+    ssd1306_tty_printf(tty, "slowest wr %lums\n", (unsigned long)(r->max_write_us / 1000));
+    ssd1306_tty_printf(tty, "%s\n", r->preallocated ? "contiguous" : "fragmented");
+    if (r->err != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "ERROR# %d\n", r->err);
+    }
+    ssd1306_tty_show(tty);
 
-    ssd1306_tty_printf(&tty, "FREE RAM: %dK %d\n", freeK, mem_size1);
-    ssd1306_tty_show(&tty);
+    while (!read_buttons_struct().any)
+    {
+        tight_loop_contents();
+    }
+}
 
-    switch_passthrough_init();
+static void toggle_recording(ssd1306_tty_t *tty)
+{
+    if (recorder_active())
+    {
+        record_report_t report;
+        recorder_stop(&report);
+        show_record_report(tty, &report);
+        show_idle_screen(tty);
+        return;
+    }
 
-    main_loop(&tty);
-    while (false)
+    FRESULT fr = (FRESULT)prep_sd_card();
+    if (fr == FR_OK)
+        fr = recorder_start();
+    if (fr != FR_OK)
     {
-        //  printf("Hello, world!\n");
+        ssd1306_tty_cls(tty);
+        ssd1306_tty_printf(tty, "REC ERROR# %d", fr);
+        ssd1306_tty_show(tty);
         sleep_ms(1000);
     }
+    show_idle_screen(tty);
 }
 
-static void reset_pal(void)
+static void show_deck(ssd1306_tty_t *tty, const char *what, const deck_status_t *st)
 {
-    /* Assert reset (active‑low) for 100 ms */
-    gpio_set_dir(PAL_RESET_GPIO, GPIO_OUT);
-    gpio_put(PAL_RESET_GPIO, 0);
-    sleep_ms(100);
-    gpio_set_dir(PAL_RESET_GPIO, GPIO_IN); /* release */
+    ssd1306_tty_cls(tty);
+    ssd1306_tty_printf(tty, "%s %s\n", what, st->name);
+    ssd1306_tty_printf(tty, "rec %lu/%lu\n",
+                       (unsigned long)MIN(st->record + 1, st->records), (unsigned long)st->records);
+    ssd1306_tty_printf(tty, "%08lu/%lu\n", (unsigned long)st->cursor, (unsigned long)st->size);
+    if (st->err != FR_OK)
+    {
+        ssd1306_tty_printf(tty, "TAPE ERROR# %d\n", st->err);
+    }
+    ssd1306_tty_puts(tty, "PLAY/MENU stops");
+    ssd1306_tty_show(tty);
 }
 
-void show_default_text(ssd1306_tty_t *tty)
+typedef struct
 {
-    ssd1306_tty_cls(tty);
-    ssd1306_tty_puts(tty, " TTY MODE\n");
-    ssd1306_tty_puts(tty, " USB<->PAL2\n");
-    // ssd1306_tty_puts(tty, " \n");
-    // ssd1306_tty_puts(tty, " MENU FOR MENU");
-    ssd1306_tty_show(tty);
+    ssd1306_tty_t *tty;
+    uint64_t next_draw;
+} deck_play_ctx_t;
+
+static bool deck_play_step(void *ctx, const deck_status_t *st)
+{
+    deck_play_ctx_t *p = (deck_play_ctx_t *)ctx;
+
+    if (time_us_64() >= p->next_draw)
+    {
+        show_deck(p->tty, "PLAY", st);
+        p->next_draw = time_us_64() + DECK_DRAW_US;
+    }
+
+    button_state_t btn = read_buttons_struct();
+    return btn.play != BUTTON_STATE_PRESSED && btn.menu != BUTTON_STATE_PRESSED;
 }
 
-void main_loop(ssd1306_tty_t *tty)
+/* ----------------------------------------------------------------
+ *  deck_transport()
+ *  – PLAY, REWIND, FF and RECORD while a tape is in the deck.
+ *    Holding REWIND/FF winds 1, then 10, then 100 records a step.
+ * ---------------------------------------------------------------- */
+static void deck_transport(ssd1306_tty_t *tty, const button_state_t *btn)
 {
-    ssd1306_tty_puts(tty, "Resetting PAL...");
-    ssd1306_tty_show(tty);
+    static uint32_t repeats;
+    int32_t dir = 0;
 
-    reset_pal();
-    ssd1306_tty_puts(tty, " done\n");
-    ssd1306_tty_show(tty);
+    if (btn->rewind)
+        dir = -1;
+    else if (btn->fast_forward)
+        dir = 1;
 
-    ssd1306_tty_puts(tty, "Boot successful, in main loop\n");
-    ssd1306_tty_show(tty);
+    if (dir)
+    {
+        repeats = (btn->rewind | btn->fast_forward) == BUTTON_STATE_REPEAT ? repeats + 1 : 0;
+        deck_wind(dir * (repeats < 8 ? 1 : repeats < 24 ? 10 : 100));
+        show_idle_screen(tty);
+    }
 
-    show_default_text(tty);
+    if (btn->play == BUTTON_STATE_PRESSED && !deck_status()->recording)
+    {
+        deck_play_ctx_t ctx = {tty, 0};
+        deck_play(deck_play_step, &ctx, NULL);
+        show_idle_screen(tty);
+    }
 
+    if (btn->record == BUTTON_STATE_PRESSED)
+    {
+        if (deck_status()->recording)
+        {
+            deck_record_stop();
+        }
+        else if (deck_record_start() != FR_OK)
+        {
+            ssd1306_tty_cls(tty);
+            ssd1306_tty_printf(tty, "TAPE ERROR# %d", deck_status()->err);
+            ssd1306_tty_show(tty);
+            sleep_ms(1000);
+        }
+        show_idle_screen(tty);
+    }
+}
+
+void main_loop(ssd1306_tty_t *tty)
+{
     while (true)
     {
+        boot_step(boot_tasks, count_of(boot_tasks));
+        boot_poll();
+        if (!boot_tasks[BOOT_DISPLAY].done)
+            continue; // nothing to draw on yet; buttons wait too
+
         // if (btn.rewind)
         // {
         //     ssd1306_tty_puts(tty, "REWIND pressed\n", 0);
@@ -220,39 +351,32 @@ void main_loop(ssd1306_tty_t *tty)
         // }
         // ssd1306_tty_show(tty);
 
-        bool idle = true;
+        /* The USB<->PAL pump runs on core 1; this core only does UI. */
+        button_state_t btn = read_buttons_struct();
 
-        /* USB‑>PAL */
-        int ch_usb = getchar_timeout_us(0);
-        if (ch_usb != PICO_ERROR_TIMEOUT)
+        if (btn.menu == BUTTON_STATE_PRESSED)
         {
-            uart_putc_raw(PAL_UART, (uint8_t)ch_usb);
-            idle = false;
-        }
+            ssd1306_tty_puts(tty, "MENU pressed\n");
 
-        /* PAL‑>USB */
-        if (uart_is_readable(PAL_UART))
+            process_menu(tty);
+            show_idle_screen(tty);
+        }
+        /* A running capture owns RECORD until it is stopped, even
+         * with a tape loaded since; otherwise RECORD appends to the
+         * tape, or starts a capture with no tape in the deck. */
+        if (btn.record == BUTTON_STATE_PRESSED && (recorder_active() || !deck_loaded()))
         {
-            int ch_pal = uart_getc(PAL_UART);
-            putchar_raw(ch_pal);
-            idle = false;
+            toggle_recording(tty);
+            btn.record = BUTTON_STATE_NONE;
         }
-
-        if (idle)
+        if (deck_loaded())
         {
-            button_state_t btn = read_buttons_struct();
-
-            if (btn.menu == BUTTON_STATE_PRESSED)
-            {
-                ssd1306_tty_puts(tty, "MENU pressed\n");
-
-                process_menu(tty);
-                show_default_text(tty);
-            }
-            else
-            {
-                sleep_ms(10);
-            }
+            deck_transport(tty, &btn);
         }
+
+        recorder_poll();
+        deck_poll();
+        session_log_poll();
+        oled_mirror_poll(tty);
     }
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "string.h"
+
+#include "pal_baud.h"
+#include "pal_baud.pio.h"
+#include "proj_hw.h"
+#include "uart_bridge.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define PAL_BOOT_MS 50        // after reset_pal() before the RUBOUT
+#define PAL_ANSWER_MS 250     // at least this long for the prompt to start
+#define PAL_ANSWER_CHARS 20   // ... or this many char times, if longer
+#define PAL_SYNC_PULSES 12    // enough of "KIM" to find one lone bit
+#define PAL_SYNC_TRIES 3
+#define PAL_BAUD_MAX 115200   // shorter pulses are glitches
+#define PAL_BAUD_TOLERANCE 4  // % off a standard rate to still call it that
+
+#define RUBOUT 0x7F // the KIM‑1 times its start bit to learn the rate
+
+static const uint32_t rates[] = PAL_BAUD_RATES;
+
+const uint32_t *pal_baud_rates(size_t *count)
+{
+    *count = count_of(rates);
+    return rates;
+}
+
+static bool within(uint32_t a, uint32_t b, uint32_t pct)
+{
+    uint32_t diff = a > b ? a - b : b - a;
+    return diff * 100 <= b * pct;
+}
+
+static uint32_t nearest_rate(uint32_t baud)
+{
+    for (size_t i = 0; i < count_of(rates); i++)
+    {
+        if (within(baud, rates[i], PAL_BAUD_TOLERANCE))
+            return rates[i];
+    }
+    return 0;
+}
+
+/* ----------------------------------------------------------------
+ *  pal_baud_measure()
+ *  – time the PAL's output for up to window_ms (or max_pulses low
+ *    pulses) on a pio1 state machine, and work out its bit rate.
+ *    A lone 0 bit is the shortest pulse; pulses up to 1.5x that
+ *    are averaged so one early sample doesn't set the answer.
+ *    Returns false if the PAL said nothing or no SM was free.
+ * ---------------------------------------------------------------- */
+bool pal_baud_measure(uint32_t window_ms, uint32_t max_pulses, pal_baud_measure_t *out)
+{
+    static uint32_t counts[64];
+    PIO pio = PAL_BAUD_PIO;
+
+    memset(out, 0, sizeof *out);
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0 || !pio_can_add_program(pio, &pal_baud_program))
+    {
+        if (sm >= 0)
+            pio_sm_unclaim(pio, sm);
+        debug_printf("pal_baud: no room on pio1\n");
+        return false;
+    }
+    uint offset = pio_add_program(pio, &pal_baud_program);
+    pal_baud_program_init(pio, sm, offset, PAL_UART_RX_GPIO);
+    pio_sm_set_enabled(pio, sm, true);
+
+    /* 2 SM cycles a count; shorter than half a bit at PAL_BAUD_MAX is noise */
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t floor = sys_hz / (4 * PAL_BAUD_MAX);
+    uint32_t n = 0;
+    absolute_time_t until = make_timeout_time_ms(window_ms);
+
+    while (n < MIN(max_pulses, count_of(counts)) && !time_reached(until))
+    {
+        if (pio_sm_is_rx_fifo_empty(pio, sm))
+            continue;
+        uint32_t c = pio_sm_get(pio, sm);
+        if (c >= floor)
+            counts[n++] = c;
+    }
+
+    pio_sm_set_enabled(pio, sm, false);
+    pio_remove_program(pio, &pal_baud_program, offset);
+    pio_sm_unclaim(pio, sm);
+
+    out->pulses = n;
+    if (n == 0)
+        return false;
+
+    uint32_t shortest = UINT32_MAX;
+    for (uint32_t i = 0; i < n; i++)
+        shortest = MIN(shortest, counts[i]);
+
+    uint64_t sum = 0;
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (counts[i] * 2 <= shortest * 3)
+        {
+            sum += counts[i];
+            k++;
+        }
+    }
+
+    out->bit_ns = (uint32_t)(sum * 2 * 1000000000ULL / ((uint64_t)k * sys_hz));
+    out->measured = (uint32_t)((uint64_t)sys_hz * k / (2 * sum));
+    out->nearest = nearest_rate(out->measured);
+
+    debug_printf("pal_baud: %lu pulses, bit %lu ns, %lu baud (%lu)\n",
+                 (unsigned long)n, (unsigned long)out->bit_ns,
+                 (unsigned long)out->measured, (unsigned long)out->nearest);
+    return true;
+}
+
+/* ----------------------------------------------------------------
+ *  pal_baud_sync()
+ *  – move PAL_UART to `baud` and have the PAL follow: reset it,
+ *    send the RUBOUT its autobaud waits for, and check the prompt
+ *    it prints back really is at `baud`.  PAL_UART stays at `baud`
+ *    either way; `ok` says whether the PAL is there too.
+ * ---------------------------------------------------------------- */
+bool pal_baud_sync(uint32_t baud, pal_baud_sync_t *out)
+{
+    memset(out, 0, sizeof *out);
+    out->baud = uart_bridge_set_baud(baud);
+
+    uint32_t answer_ms = MAX(PAL_ANSWER_MS, PAL_ANSWER_CHARS * 10 * 1000 / out->baud);
+
+    while (!out->ok && out->tries < PAL_SYNC_TRIES)
+    {
+        out->tries++;
+
+        reset_pal();
+        sleep_ms(PAL_BOOT_MS);
+
+        uart_bridge_putc(RUBOUT);
+        uart_bridge_wait_tx_done(); // only time what the PAL sends back
+
+        if (pal_baud_measure(answer_ms, PAL_SYNC_PULSES, &out->m))
+            out->ok = within(out->m.measured, out->baud, PAL_BAUD_TOLERANCE);
+
+        debug_printf("pal_baud: try %lu at %lu: %s\n", (unsigned long)out->tries,
+                     (unsigned long)out->baud, out->ok ? "ok" : "no");
+    }
+    return out->ok;
+}
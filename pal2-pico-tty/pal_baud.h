@@ -0,0 +1,35 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+
+#define PAL_BAUD_PIO pio1 // pio0's instruction memory is wiped by the switch mirror
+#define PAL_BAUD_RATES {300, 600, 1200, 2400, 4800, 9600, 19200}
+
+    typedef struct
+    {
+        uint32_t pulses;   // low pulses seen on the PAL's TX line
+        uint32_t bit_ns;   // one bit, from the shortest of them
+        uint32_t measured; // baud from bit_ns, 0 if nothing came
+        uint32_t nearest;  // closest of PAL_BAUD_RATES, 0 if none is close
+    } pal_baud_measure_t;
+
+    typedef struct
+    {
+        uint32_t baud;     // PAL_UART rate now set
+        uint32_t tries;    // resets + RUBOUTs it took
+        bool ok;           // the PAL answered at `baud`
+        pal_baud_measure_t m; // of the last answer
+    } pal_baud_sync_t;
+
+    const uint32_t *pal_baud_rates(size_t *count);
+    bool pal_baud_measure(uint32_t window_ms, uint32_t max_pulses, pal_baud_measure_t *out);
+    bool pal_baud_sync(uint32_t baud, pal_baud_sync_t *out);
+
+#ifdef __cplusplus
+}
+#endif
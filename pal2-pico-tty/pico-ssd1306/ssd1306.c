@@ -25,6 +25,7 @@ SOFTWARE.
 
 #include <pico/stdlib.h>
 #include <hardware/i2c.h>
+#include <hardware/dma.h>
 #include <pico/binary_info.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,6 +37,18 @@ SOFTWARE.
 #include "debug.h"
 
 static bool text_inv_mode = false;
+
+/* One frame in flight: the Co-bit commands, the 0x40 data control byte
+ * and the data, as IC_DATA_CMD words (STOP set on the last one).     */
+#define FLUSH_TIMEOUT_US (200 * 1000)
+static uint16_t flush_words[2 * 7 + 1 + 128 * 64 / 8];
+static uint64_t flush_started_us;
+
+/* Frames per second, reported over debug_printf once a second */
+#define FPS_WINDOW_US (1000 * 1000)
+static uint32_t fps_frames;
+static uint32_t fps_bytes;
+static uint64_t fps_since_us;
 void ssd1306_tty_show2(ssd1306_tty_t *tty);
 
 inline static void swap(int32_t *a, int32_t *b)
@@ -64,6 +77,7 @@ inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src
 inline static void ssd1306_write(ssd1306_t *p, uint8_t val)
 {
     uint8_t d[2] = {0x00, val};
+    ssd1306_wait(p); // the bus is still busy with a frame
     fancy_write(p->i2c_i, p->address, d, 2, "ssd1306_write");
 }
 
@@ -75,6 +89,9 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
     p->address = address;
 
     p->i2c_i = i2c_instance;
+    p->dma_chan = -1;
+    p->flushing = false;
+    p->start_line = 0;
 
     p->bufsize = (p->pages) * (p->width);
     if ((p->buffer = malloc(p->bufsize + 1)) == NULL)
@@ -85,6 +102,14 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
 
     ++(p->buffer);
 
+    if ((p->front = malloc(p->bufsize)) == NULL)
+    {
+        free(p->buffer - 1);
+        p->bufsize = 0;
+        return false;
+    }
+    p->front_valid = false; // panel RAM is random until the first show
+
     // from https://github.com/makerportal/rpi-pico-ssd1306
     uint8_t cmds[] = {
         SET_DISP,
@@ -127,6 +152,10 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
 
 inline void ssd1306_deinit(ssd1306_t *p)
 {
+    ssd1306_wait(p);
+    if (p->dma_chan >= 0)
+        dma_channel_unclaim(p->dma_chan);
+    free(p->front);
     free(p->buffer - 1);
 }
 
@@ -220,11 +249,10 @@ void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t wi
     ssd1306_draw_line(p, x + width, y, x + width, y + height);
 }
 
-void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, int scale, const uint8_t *font, char c)
+/* Per pixel, for any font height and scale: the original routine,
+ * now only used for glyphs taller than 32 scaled pixels.            */
+static void draw_char_per_pixel(ssd1306_t *p, uint32_t x, uint32_t y, int scale, const uint8_t *font, char c)
 {
-    if (c < font[3] || c > font[4])
-        return;
-
     uint32_t parts_per_line = (font[0] >> 3) + ((font[0] & 7) > 0);
     for (uint8_t w = 0; w < font[1]; ++w)
     { // width
@@ -252,6 +280,82 @@ void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, int scale
     }
 }
 
+/* Stretch the low n bits of a glyph column to n * scale bits */
+static inline uint32_t scale_column(uint32_t bits, uint32_t n, int scale)
+{
+    uint32_t out = 0;
+    uint32_t run = (1u << scale) - 1;
+
+    for (uint32_t j = 0; j < n; ++j)
+    {
+        if ((bits >> j) & 1)
+            out |= run << (j * scale);
+    }
+    return out;
+}
+
+/* Write the h (<= 32) pixel rows of one column starting at row y:
+ * shift the column to the row's bit in its page, then mask it into
+ * each page it spans.  Rows and columns off the panel are dropped.  */
+static inline void blit_column(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t bits, uint32_t h)
+{
+    if (x >= p->width)
+        return;
+
+    uint64_t mask = (h >= 32 ? 0xFFFFFFFFull : (1ull << h) - 1) << (y & 7);
+    uint64_t data = ((uint64_t)bits << (y & 7)) & mask;
+    uint8_t *col = p->buffer + x;
+
+    for (uint32_t page = y >> 3; mask && page < p->pages; ++page, mask >>= 8, data >>= 8)
+    {
+        uint8_t m = (uint8_t)mask;
+        col[page * p->width] = (col[page * p->width] & ~m) | ((uint8_t)data & m);
+    }
+}
+
+void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, int scale, const uint8_t *font, char c)
+{
+    if (c < font[3] || c > font[4])
+        return;
+
+    uint32_t parts_per_line = (font[0] >> 3) + ((font[0] & 7) > 0);
+    uint32_t rows = (parts_per_line << 3) * scale;
+    const uint8_t *glyph = font + (c - font[3]) * font[1] * parts_per_line + 5;
+
+    if (rows > 32)
+    {
+        draw_char_per_pixel(p, x, y, scale, font, c);
+        return;
+    }
+
+    if (scale == 1 && parts_per_line == 1 && !(y & 7))
+    {
+        // Page aligned, one byte per column: copy the glyph straight in
+        if (y >= p->height)
+            return;
+
+        uint8_t *dst = p->buffer + (y >> 3) * p->width + x;
+        for (uint8_t w = 0; w < font[1] && x + w < p->width; ++w)
+            dst[w] = text_inv_mode ? ~glyph[w] : glyph[w];
+        return;
+    }
+
+    for (uint8_t w = 0; w < font[1]; ++w, glyph += parts_per_line)
+    {
+        uint32_t bits = 0;
+        for (uint32_t lp = 0; lp < parts_per_line; ++lp)
+            bits |= (uint32_t)glyph[lp] << (lp << 3);
+
+        if (text_inv_mode)
+            bits = ~bits;
+        if (scale > 1)
+            bits = scale_column(bits, parts_per_line << 3, scale);
+
+        for (int s = 0; s < scale; ++s)
+            blit_column(p, x + w * scale + s, y, bits, rows);
+    }
+}
+
 void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, int scale, const uint8_t *font, const char *s)
 {
 
@@ -348,21 +452,163 @@ inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long
     ssd1306_bmp_show_image_with_offset(p, data, size, 0, 0);
 }
 
+/* Queue one transaction for the DMA: set the window, then send the
+ * rectangle of the buffer it covers.  The buffer is copied into
+ * flush_words, so drawing can carry on as soon as this returns.     */
+static void flush_start(ssd1306_t *p, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1)
+{
+    i2c_hw_t *hw = i2c_get_hw(p->i2c_i);
+    uint8_t offset = p->width == 64 ? 32 : 0;
+    uint8_t cmds[] = {SET_DISP_START_LINE | p->start_line,
+                      SET_COL_ADDR, col0 + offset, col1 + offset, SET_PAGE_ADDR, page0, page1};
+    uint16_t *w = flush_words;
+
+    ssd1306_wait(p);
+
+    for (size_t i = 0; i < sizeof(cmds); ++i)
+    {
+        *w++ = 0x80; // Co = 1, D/C# = 0: one command byte follows
+        *w++ = cmds[i];
+    }
+    *w++ = 0x40; // Co = 0, D/C# = 1: data to the end
+    for (uint8_t page = page0; page <= page1; ++page)
+    {
+        const uint8_t *src = p->buffer + page * p->width;
+        uint8_t *front = p->front + page * p->width;
+        for (uint8_t col = col0; col <= col1; ++col)
+            *w++ = src[col];
+        memcpy(front + col0, src + col0, col1 - col0 + 1); // copy on flip
+    }
+    w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    if (p->dma_chan < 0)
+        p->dma_chan = dma_claim_unused_channel(true);
+
+    hw->enable = 0;
+    hw->tar = p->address;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+
+    dma_channel_config c = dma_channel_get_default_config(p->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(p->i2c_i, true));
+    dma_channel_configure(p->dma_chan, &c, &hw->data_cmd, flush_words, w - flush_words, true);
+
+    p->flushing = true;
+    flush_started_us = time_us_64();
+
+    fps_frames++;
+    fps_bytes += (w - flush_words) + 1; // + address byte
+    if (flush_started_us - fps_since_us >= FPS_WINDOW_US)
+    {
+#if ENABLE_DEBUG
+        uint64_t dt = flush_started_us - fps_since_us;
+        debug_printf("oled: %lu fps, %lu bytes/s\n",
+                     (unsigned long)(fps_frames * 1000000ull / dt),
+                     (unsigned long)(fps_bytes * 1000000ull / dt));
+#endif
+        fps_frames = 0;
+        fps_bytes = 0;
+        fps_since_us = flush_started_us;
+    }
+}
+
+bool ssd1306_busy(ssd1306_t *p)
+{
+    if (!p->flushing)
+        return false;
+
+    i2c_hw_t *hw = i2c_get_hw(p->i2c_i);
+
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+    {
+        printf("[ssd1306_show] addr not acknowledged!\n");
+        dma_channel_abort(p->dma_chan);
+        (void)hw->clr_tx_abrt;
+        p->flushing = false;
+        return false;
+    }
+
+    if (dma_channel_is_busy(p->dma_chan) || !(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS))
+    {
+        if (time_us_64() - flush_started_us < FLUSH_TIMEOUT_US)
+            return true;
+
+        printf("[ssd1306_show] timeout!\n");
+        dma_channel_abort(p->dma_chan);
+    }
+
+    (void)hw->clr_stop_det;
+    p->flushing = false;
+    return false;
+}
+
+void ssd1306_wait(ssd1306_t *p)
+{
+    while (ssd1306_busy(p))
+        tight_loop_contents();
+}
+
 void ssd1306_show(ssd1306_t *p)
 {
-    uint8_t payload[] = {SET_COL_ADDR, 0, p->width - 1, SET_PAGE_ADDR, 0, p->pages - 1};
-    if (p->width == 64)
+    flush_start(p, 0, p->pages - 1, 0, p->width - 1);
+    p->front_valid = true;
+}
+
+/* ----------------------------------------------------------------
+ *  ssd1306_present()
+ *  – flip the back buffer (p->buffer) to the panel: compare it with
+ *    the front copy, send only the rectangle that differs, and copy
+ *    that rectangle to the front.  Drawing the next frame can start
+ *    as soon as this returns, while the DMA sends this one.
+ * ---------------------------------------------------------------- */
+void ssd1306_present(ssd1306_t *p)
+{
+    if (!p->front_valid)
     {
-        payload[1] += 32;
-        payload[2] += 32;
+        ssd1306_show(p);
+        return;
     }
 
-    for (size_t i = 0; i < sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
+    int page0 = -1, page1 = -1;
+    uint8_t col0 = 0xFF, col1 = 0;
 
-    *(p->buffer - 1) = 0x40;
+    for (uint8_t page = 0; page < p->pages; ++page)
+    {
+        const uint8_t *back = p->buffer + page * p->width;
+        const uint8_t *front = p->front + page * p->width;
+
+        if (memcmp(back, front, p->width) == 0)
+            continue;
+
+        uint8_t lo = 0, hi = p->width - 1;
+        while (back[lo] == front[lo])
+            ++lo;
+        while (back[hi] == front[hi])
+            --hi;
+
+        if (page0 < 0)
+            page0 = page;
+        page1 = page;
+        col0 = MIN(col0, lo);
+        col1 = MAX(col1, hi);
+    }
 
-    fancy_write(p->i2c_i, p->address, p->buffer - 1, p->bufsize + 1, "ssd1306_show");
+    if (page0 >= 0)
+        flush_start(p, page0, page1, col0, col1);
+}
+
+void ssd1306_show_area(ssd1306_t *p, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1)
+{
+    flush_start(p, page0, page1, col0, col1);
+}
+
+void ssd1306_set_start_line(ssd1306_t *p, uint8_t line)
+{
+    p->start_line = line & 0x3F;
 }
 
 void ssd1306_set_text_inv(ssd1306_t *p, const bool mode)
@@ -381,11 +627,46 @@ void ssd1306_printf(ssd1306_t *p, uint32_t x, uint32_t y, int scale, const char
     ssd1306_draw_string(p, x, y, scale, buf);
 }
 
-static void aaa(ssd1306_t *p);
+static void aaa(ssd1306_t *p) __attribute__((unused)); // demo, call commented out in ssd1306_init_tty()
 
 #define MAX_TTY_X 80
 #define MAX_TTY_Y 25
 
+// Set true to repaint and resend the whole screen on every show, to
+// compare against the dirty-cell path in the "Time to draw" output.
+#define TTY_FORCE_FULL_REDRAW false
+
+static inline void tty_set_cell(ssd1306_tty_t *tty, int idx, char c)
+{
+    if (tty->buffer[idx] != c)
+    {
+        tty->buffer[idx] = c;
+        tty->dirty[idx] = 1;
+    }
+}
+
+void ssd1306_tty_invalidate(ssd1306_tty_t *tty)
+{
+    tty->full_redraw = true;
+}
+
+/* With hardware scroll the rows are a ring of pages starting at
+ * tty->top; without it tty->top stays 0.                            */
+static inline int tty_row(const ssd1306_tty_t *tty, int y)
+{
+    return (y + tty->top) % tty->height;
+}
+
+static void tty_reset_top(ssd1306_tty_t *tty)
+{
+    if (tty->top != 0)
+    {
+        tty->top = 0;
+        tty->full_redraw = true; // every row moves to a new page
+    }
+    ssd1306_set_start_line(tty->ssd1306, 0);
+}
+
 void ssd1306_tty_set_scale(ssd1306_tty_t *tty, int scale)
 {
 
@@ -394,6 +675,12 @@ void ssd1306_tty_set_scale(ssd1306_tty_t *tty, int scale)
     tty->scale = scale;
     tty->height = tty->ssd1306->height / tty->font_height;
     tty->width = tty->ssd1306->width / tty->font_width;
+    tty->full_redraw = true; // cells moved, old pixels are stale
+
+    // One text row per page: scroll by moving the panel's start line
+    tty->hw_scroll = tty->font_height == 8 && tty->height == tty->ssd1306->pages;
+    tty->top = 0;
+    ssd1306_set_start_line(tty->ssd1306, 0);
     debug_printf("TTY CONFIG: height/width %d/%d\n", tty->height, tty->width);
 }
 
@@ -409,23 +696,50 @@ void ssd1306_tty_set_font(ssd1306_tty_t *tty, const uint8_t *font, int scale)
 
 void ssd1306_tty_scroll(ssd1306_tty_t *tty)
 {
-    // Move all rows up by one
+    if (tty->hw_scroll)
+    {
+        // The top row's page becomes the new, blank bottom row and the
+        // panel starts scanning one page further down: one page to
+        // clear and send instead of every cell.
+        int row_size = tty->width;
+        int bottom = tty->top * row_size;
+
+        tty->top = (tty->top + 1) % tty->height;
+        for (int i = bottom; i < bottom + row_size; i++)
+        {
+            tty->buffer[i] = ' ';
+            tty->dirty[i] = 1; // even if blank: the flush carries the start line
+        }
+        memset(tty->color + bottom, 0, row_size);
+        ssd1306_set_start_line(tty->ssd1306, tty->top * 8);
+
+        tty->y = tty->height - 1;
+        return;
+    }
+
+    // Move all rows up by one, marking only the cells that change
     int row_size = tty->width;
-    memmove(tty->buffer, tty->buffer + row_size, (tty->height - 1) * row_size);
-    memmove(tty->color, tty->color + row_size, (tty->height - 1) * row_size);
+    int moved = (tty->height - 1) * row_size;
+    for (int i = 0; i < moved; i++)
+        tty_set_cell(tty, i, tty->buffer[i + row_size]);
+    memmove(tty->color, tty->color + row_size, moved);
 
     // Clear the last row
-    memset(tty->buffer + (tty->height - 1) * row_size, ' ', row_size);
-    memset(tty->color + (tty->height - 1) * row_size, 0, row_size);
+    for (int i = moved; i < moved + row_size; i++)
+        tty_set_cell(tty, i, ' ');
+    memset(tty->color + moved, 0, row_size);
 
     tty->y = tty->height - 1;
 }
 
 void ssd1306_tty_cls(ssd1306_tty_t *tty)
 {
-    ssd1306_clear(tty->ssd1306);
-    memset(tty->buffer, ' ', tty->width * tty->height);
+    // Blank the cells rather than the framebuffer, so a redraw of the
+    // same text (menus do cls + puts each pass) costs nothing.
+    for (int i = 0; i < tty->width * tty->height; i++)
+        tty_set_cell(tty, i, ' ');
     memset(tty->color, 0, tty->width * tty->height);
+    tty_reset_top(tty);
     tty->x = 0;
     tty->y = 0;
 
@@ -464,8 +778,8 @@ void ssd1306_tty_writechar(ssd1306_tty_t *tty, char c)
         }
     }
 
-    int idx = tty->y * tty->width + tty->x;
-    tty->buffer[idx] = c;
+    int idx = tty_row(tty, tty->y) * tty->width + tty->x;
+    tty_set_cell(tty, idx, c);
     // tty->color[idx] = color;
 
     tty->x++;
@@ -478,7 +792,7 @@ void ssd1306_tty_dump(ssd1306_tty_t *tty)
     {
         for (int x = 0; x < tty->width; x++)
         {
-            char c = tty->buffer[y * tty->width + x];
+            char c = tty->buffer[tty_row(tty, y) * tty->width + x];
             putchar((c >= 32 && c <= 126) ? c : '.'); // printable ASCII or placeholder
         }
         putchar('\n');
@@ -486,35 +800,104 @@ void ssd1306_tty_dump(ssd1306_tty_t *tty)
     printf("---> DUMP\n");
 }
 
-void ssd1306_tty_show2(ssd1306_tty_t *tty)
+/* Widen the page ranges to cover one cell's pixels */
+static void tty_mark_area(ssd1306_tty_t *tty, int px, int py)
 {
+    ssd1306_t *p = tty->ssd1306;
+    int x1 = MIN(px + tty->font_width, p->width) - 1;
+    int page1 = (MIN(py + tty->font_height, p->height) - 1) >> 3;
+
+    for (int page = py >> 3; page <= page1; page++)
+    {
+        tty->dirty_col_lo[page] = MIN(tty->dirty_col_lo[page], px);
+        tty->dirty_col_hi[page] = MAX(tty->dirty_col_hi[page], x1);
+    }
+}
+
+/* Repaint the dirty cells and queue the pages they touch; returns
+ * the number of cells drawn.                                         */
+static int tty_render(ssd1306_tty_t *tty)
+{
+    ssd1306_t *p = tty->ssd1306;
+    int cells = tty->width * tty->height;
+    int drawn = 0;
+    bool full = tty->full_redraw || TTY_FORCE_FULL_REDRAW;
+
+    if (full)
+    {
+        ssd1306_clear(p);
+        memset(tty->dirty, 1, cells);
+    }
+
+    memset(tty->dirty_col_lo, 0xFF, sizeof tty->dirty_col_lo);
+    memset(tty->dirty_col_hi, 0, sizeof tty->dirty_col_hi);
+
     for (int y = 0; y < tty->height; y++)
     {
         for (int x = 0; x < tty->width; x++)
         {
-            char c = tty->buffer[y * tty->width + x];
-            // putchar((c >= 32 && c <= 126) ? c : '.'); // printable ASCII or placeholder
+            int idx = y * tty->width + x;
+            if (!tty->dirty[idx])
+                continue;
 
             int px = x * (tty->font_width);
             int py = y * (tty->font_height);
 
-            ssd1306_draw_char_with_font(tty->ssd1306, px, py, tty->scale, tty->font, c);
+            ssd1306_draw_char_with_font(p, px, py, tty->scale, tty->font, tty->buffer[idx]);
+            tty_mark_area(tty, px, py);
+            tty->dirty[idx] = 0;
+            drawn++;
         }
     }
-    ssd1306_show(tty->ssd1306);
+
+    if (full)
+    {
+        ssd1306_show(p);
+    }
+    else
+    {
+        // One window around every touched page: a single transaction
+        int page0 = -1, page1 = -1;
+        uint8_t col0 = 0xFF, col1 = 0;
+        for (int page = 0; page < p->pages; page++)
+        {
+            if (tty->dirty_col_lo[page] > tty->dirty_col_hi[page])
+                continue;
+            if (page0 < 0)
+                page0 = page;
+            page1 = page;
+            col0 = MIN(col0, tty->dirty_col_lo[page]);
+            col1 = MAX(col1, tty->dirty_col_hi[page]);
+        }
+        if (page0 >= 0)
+            ssd1306_show_area(p, page0, page1, col0, col1);
+    }
+    tty->full_redraw = false;
+
+    return drawn;
+}
+
+void ssd1306_tty_show2(ssd1306_tty_t *tty)
+{
+    tty_render(tty);
 }
 
 void ssd1306_tty_show(ssd1306_tty_t *tty)
 {
-    // ssd1306_tty_show2(tty);               // original routine
-    // return;
+#if ENABLE_DEBUG
+    bool full = tty->full_redraw || TTY_FORCE_FULL_REDRAW;
 
     uint64_t t0 = time_us_64();      // start‑stamp
-    ssd1306_tty_show2(tty);          // original routine
+    int drawn = tty_render(tty);
     uint64_t dt = time_us_64() - t0; // elapsed
 
-    debug_printf("Time to draw screen %" PRIu64 " µs\n", dt);
-    //    return (uint32_t)dt;                 // ≤ ~71 min fits in 32 bits
+    if (drawn)
+        debug_printf("Time to draw screen %" PRIu64 " µs (%d cells, %s)\n",
+                     dt, drawn, full ? "full" : "dirty pages");
+    //    return (uint32_t)dt;                 // ≤ ~71 min fits in 32 bits
+#else
+    tty_render(tty);
+#endif
 }
 
 void ssd1306_init_tty(ssd1306_t *p, ssd1306_tty_t *tty, const uint8_t *font)
@@ -523,6 +906,9 @@ void ssd1306_init_tty(ssd1306_t *p, ssd1306_tty_t *tty, const uint8_t *font)
     tty->bufsize = MAX_TTY_X * MAX_TTY_Y;
     tty->buffer = malloc(MAX_TTY_X * MAX_TTY_Y);
     tty->color = malloc(MAX_TTY_X * MAX_TTY_Y);
+    tty->dirty = malloc(MAX_TTY_X * MAX_TTY_Y);
+    memset(tty->buffer, ' ', MAX_TTY_X * MAX_TTY_Y);
+    tty->full_redraw = true;
 
     ssd1306_tty_set_font(tty, font, 1);
 
@@ -37,6 +37,8 @@ extern "C"
 #include <pico/stdlib.h>
 #include <hardware/i2c.h>
 
+#define SSD1306_MAX_PAGES 8 /**< 64 pixel high panels */
+
 	/**
 	 *	@brief defines commands used in ssd1306
 	 */
@@ -74,6 +76,11 @@ extern "C"
 		bool external_vcc; /**< whether display uses external vcc */
 		uint8_t *buffer;   /**< display buffer */
 		size_t bufsize;	   /**< buffer size */
+		uint8_t *front;	   /**< what the panel shows: buffer as of the last show/present */
+		bool front_valid;  /**< front matches the panel (false until the first show) */
+		int dma_chan;	   /**< DMA channel for flushes, -1 until the first */
+		bool flushing;	   /**< a flush is on the bus */
+		uint8_t start_line; /**< RAM row shown at the top, sent with each flush */
 	} ssd1306_t;
 
 	/**
@@ -93,6 +100,12 @@ extern "C"
 		int y; /* The y position */
 		int font_height;
 		int font_width;
+		uint8_t *dirty;		/**< one flag per cell, set when the cell changes */
+		bool full_redraw;	/**< framebuffer no longer matches the cells */
+		uint8_t dirty_col_lo[SSD1306_MAX_PAGES]; /**< per page: first changed column */
+		uint8_t dirty_col_hi[SSD1306_MAX_PAGES]; /**< per page: last changed column */
+		bool hw_scroll;		/**< one row per page: scroll with the display start line */
+		int top;			/**< page holding row 0 when hw_scroll */
 
 	} ssd1306_tty_t;
 
@@ -156,11 +169,62 @@ extern "C"
 	/**
 		@brief display buffer, should be called on change
 
+		Queues the whole buffer as one I2C transaction sent by DMA and
+		returns at once; the buffer may be drawn on straight away.
+
 		@param[in] p : instance of display
 
 	*/
 	void ssd1306_show(ssd1306_t *p);
 
+	/**
+		@brief like ssd1306_show, but only sends the part of the buffer
+		that changed since the last show or present
+
+		@param[in] p : instance of display
+
+	*/
+	void ssd1306_present(ssd1306_t *p);
+
+	/**
+		@brief set the RAM row shown at the top of the panel (0..63);
+		takes effect with the next show, present or show_area
+
+		@param[in] p : instance of display
+		@param[in] line : display start line
+
+	*/
+	void ssd1306_set_start_line(ssd1306_t *p, uint8_t line);
+
+	/**
+		@brief whether a flush is still on the bus
+
+		@param[in] p : instance of display
+
+		@return true while the last show is being sent
+	*/
+	bool ssd1306_busy(ssd1306_t *p);
+
+	/**
+		@brief wait for the last show to finish
+
+		@param[in] p : instance of display
+
+	*/
+	void ssd1306_wait(ssd1306_t *p);
+
+	/**
+		@brief like ssd1306_show, for pages page0..page1, columns col0..col1
+
+		@param[in] p : instance of display
+		@param[in] page0 : first page (8 pixel rows)
+		@param[in] page1 : last page
+		@param[in] col0 : first column
+		@param[in] col1 : last column
+
+	*/
+	void ssd1306_show_area(ssd1306_t *p, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1);
+
 	/**
 		@brief clear display buffer
 
@@ -317,6 +381,14 @@ extern "C"
 	void ssd1306_tty_cls(ssd1306_tty_t *tty);
 	void ssd1306_tty_set_scale(ssd1306_tty_t *tty, int scale);
 
+	/**
+		@brief the framebuffer was drawn on directly; the next
+		ssd1306_tty_show() repaints every cell
+
+		@param[in] tty : instance of tty
+	*/
+	void ssd1306_tty_invalidate(ssd1306_tty_t *tty);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,100 @@
+/*
+ * glyph_bench: glyphs per second for the ssd1306 text blitter, on the
+ * host.  ssd1306.c is built into this file so the per-pixel fallback
+ * can be timed next to the column-byte fast path and the
+ * shift-and-mask path.
+ *
+ *   make glyph_bench && ./glyph_bench
+ */
+#include "../ssd1306.c"
+
+#define GLYPHS 200000
+
+typedef void (*draw_fn)(ssd1306_t *p, uint32_t x, uint32_t y, int scale, const uint8_t *font, char c);
+
+static uint8_t framebuffer[1 + 128 * 64 / 8];
+
+static void bench(const char *name, draw_fn draw, uint32_t y0, int scale, bool inv)
+{
+    ssd1306_t p = {
+        .width = 128,
+        .height = 64,
+        .pages = 8,
+        .buffer = framebuffer + 1,
+        .bufsize = sizeof framebuffer - 1,
+    };
+    uint32_t cell_w = (font_8x5[1] + font_8x5[2]) * scale;
+    uint32_t cell_h = font_8x5[0] * scale;
+    uint32_t x = 0, y = y0;
+    uint32_t sum = 0;
+
+    ssd1306_set_text_inv(&p, inv);
+
+    uint64_t t0 = time_us_64();
+    for (int i = 0; i < GLYPHS; i++)
+    {
+        draw(&p, x, y, scale, font_8x5, (char)(' ' + i % 95));
+        x += cell_w;
+        if (x + cell_w > p.width)
+        {
+            x = 0;
+            y += cell_h;
+            if (y + cell_h > p.height)
+                y = y0;
+        }
+    }
+    uint64_t dt = time_us_64() - t0;
+
+    for (size_t i = 0; i < p.bufsize; i++) // keep the stores alive
+        sum += p.buffer[i];
+
+    ssd1306_set_text_inv(&p, false);
+    printf("%-28s %10.0f glyphs/s  (%llu us, sum %u)\n", name,
+           GLYPHS * 1e6 / (dt ? dt : 1), (unsigned long long)dt, sum);
+}
+
+/* Both routines must leave the same pixels behind */
+static int check(uint32_t y, int scale, bool inv)
+{
+    static uint8_t a[1 + 1024], b[1 + 1024];
+    ssd1306_t pa = {.width = 128, .height = 64, .pages = 8, .buffer = a + 1, .bufsize = 1024};
+    ssd1306_t pb = pa;
+    pb.buffer = b + 1;
+
+    memset(a, 0xA5, sizeof a);
+    memset(b, 0xA5, sizeof b);
+    ssd1306_set_text_inv(&pa, inv);
+    for (int c = ' '; c < 127; c++)
+    {
+        uint32_t x = (c * 7) % 124;
+        uint32_t yy = (y + c) % 60;
+        draw_char_per_pixel(&pa, x, yy, scale, font_8x5, (char)c);
+        ssd1306_draw_char_with_font(&pb, x, yy, scale, font_8x5, (char)c);
+    }
+    ssd1306_set_text_inv(&pa, false);
+    return memcmp(a, b, sizeof a) != 0;
+}
+
+int main(void)
+{
+    int bad = 0;
+    for (int scale = 1; scale <= 4; scale++)
+    {
+        for (uint32_t y = 0; y < 8; y++)
+        {
+            bad += check(y, scale, false);
+            bad += check(y, scale, true);
+        }
+    }
+    printf("blitter vs per-pixel: %s\n\n", bad ? "MISMATCH" : "identical");
+
+    bench("per-pixel, aligned", draw_char_per_pixel, 0, 1, false);
+    bench("blitter, aligned", ssd1306_draw_char_with_font, 0, 1, false);
+    bench("blitter, aligned, inverse", ssd1306_draw_char_with_font, 0, 1, true);
+    bench("per-pixel, unaligned", draw_char_per_pixel, 3, 1, false);
+    bench("blitter, unaligned", ssd1306_draw_char_with_font, 3, 1, false);
+    bench("per-pixel, scale 3", draw_char_per_pixel, 1, 3, false);
+    bench("blitter, scale 3", ssd1306_draw_char_with_font, 1, 3, false);
+
+    return bad != 0;
+}
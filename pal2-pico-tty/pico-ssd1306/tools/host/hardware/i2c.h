@@ -0,0 +1,41 @@
+/* I2C that goes nowhere: the host tools only look at the framebuffer */
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+typedef struct
+{
+    volatile uint32_t tar, data_cmd, raw_intr_stat, clr_tx_abrt, clr_stop_det, enable;
+} i2c_hw_t;
+
+#define i2c0 ((i2c_inst_t *)0)
+#define i2c1 ((i2c_inst_t *)0)
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x200
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS 0x200
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x40
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    static i2c_hw_t hw = {.raw_intr_stat = I2C_IC_RAW_INTR_STAT_STOP_DET_BITS};
+    (void)i2c;
+    return &hw;
+}
+
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+    (void)i2c;
+    (void)is_tx;
+    return 0;
+}
+
+static inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return (int)len;
+}
@@ -0,0 +1,39 @@
+/* Just enough of the Pico SDK for ssd1306.c to build on the host */
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef unsigned int uint;
+
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+enum
+{
+    PICO_OK = 0,
+    PICO_ERROR_GENERIC = -1,
+    PICO_ERROR_TIMEOUT = -2,
+};
+
+static inline uint64_t time_us_64(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline void sleep_ms(uint32_t ms)
+{
+    usleep(ms * 1000);
+}
+
+static inline void tight_loop_contents(void) {}
@@ -0,0 +1,199 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "ctype.h"
+
+#include "profiles.h"
+#include "sd-card/sd-card.h"
+#include "proj_hw.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Built‑in profiles, used as‑is when PROFILE_CONFIG_PATH is missing
+ *  and written out so there is something to edit.  The last entry
+ *  (no extensions) catches every file type not listed above it.
+ *  Baud 0 keeps whatever rate PAL BAUD last synced the PAL to; any
+ *  other rate resets the PAL first (pacer_begin()), which would drop
+ *  BASIC or FOCAL back to the monitor, so the built‑ins leave it 0.
+ * ---------------------------------------------------------------- */
+static const transfer_profile_t builtin_profiles[] = {
+    /* the monitor's L stores each byte pair as it lands; at CR it
+     * only checks the record's checksum                              */
+    {"KIM monitor hex", "ptp kim pap bin prg hex ihx s19 s28 s37 srec mot", {0, 2, 20, true, 10}},
+    /* BASIC tokenises and links each line on CR, slower as the
+     * program grows; characters in between only go to the buffer     */
+    {"MS BASIC listing", "bas", {0, 5, 400, true, 120}},
+    /* FOCAL stores the line as typed, no tokenising                  */
+    {"FOCAL", "foc fcl", {0, 10, 250, true, 60}},
+    {"Default", "", {0, 20, 200, true, 50}},
+};
+
+static transfer_profile_t profiles[MAX_PROFILES];
+static size_t profile_count;
+static bool loaded;
+
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s))
+        s++;
+
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+
+    return s;
+}
+
+static void use_builtins(void)
+{
+    profile_count = count_of(builtin_profiles);
+    memcpy(profiles, builtin_profiles, sizeof builtin_profiles);
+}
+
+static void write_builtins(void)
+{
+    FIL fp;
+
+    if (f_open(&fp, PROFILE_CONFIG_PATH, FA_WRITE | FA_CREATE_NEW) != FR_OK)
+        return;
+
+    f_printf(&fp, "# PAL-2 transfer profiles, picked by file extension.\n");
+    f_printf(&fp, "# Delays in ms. With echo_wait=1 the delays are only timeouts.\n");
+    f_printf(&fp, "# baud 0 keeps the link rate; any other resets the PAL to move it.\n");
+    for (size_t i = 0; i < count_of(builtin_profiles); i++)
+    {
+        const transfer_profile_t *p = &builtin_profiles[i];
+        f_printf(&fp, "\n[%s]\n", p->name);
+        f_printf(&fp, "ext = %s\n", p->exts);
+        f_printf(&fp, "baud = %lu\n", (unsigned long)p->pace.baud);
+        f_printf(&fp, "char_delay = %lu\n", (unsigned long)p->pace.char_delay_ms);
+        f_printf(&fp, "line_delay = %lu\n", (unsigned long)p->pace.line_delay_ms);
+        f_printf(&fp, "echo_wait = %d\n", p->pace.echo_wait ? 1 : 0);
+        f_printf(&fp, "line_quiet = %lu\n", (unsigned long)p->pace.line_quiet_ms);
+    }
+    f_close(&fp);
+}
+
+static void set_key(transfer_profile_t *p, const char *key, const char *value)
+{
+    uint32_t n = strtoul(value, NULL, 10);
+
+    if (strcasecmp(key, "ext") == 0)
+    {
+        strncpy(p->exts, value, PROFILE_EXT_LEN - 1);
+        p->exts[PROFILE_EXT_LEN - 1] = '\0';
+    }
+    else if (strcasecmp(key, "baud") == 0)
+        p->pace.baud = n;
+    else if (strcasecmp(key, "char_delay") == 0)
+        p->pace.char_delay_ms = n;
+    else if (strcasecmp(key, "line_delay") == 0)
+        p->pace.line_delay_ms = n;
+    else if (strcasecmp(key, "echo_wait") == 0)
+        p->pace.echo_wait = n != 0;
+    else if (strcasecmp(key, "line_quiet") == 0)
+        p->pace.line_quiet_ms = n;
+    else
+        debug_printf("profiles: unknown key '%s'\n", key);
+}
+
+/* ----------------------------------------------------------------
+ *  profiles_load()
+ *  – parse PROFILE_CONFIG_PATH (ini style: [name] then key = value).
+ *    Keys a section leaves out keep the "Default" values.
+ *    Returns the number of profiles available.
+ * ---------------------------------------------------------------- */
+int profiles_load(void)
+{
+    FIL fp;
+    char line[80];
+    transfer_profile_t *cur = NULL;
+    const transfer_profile_t *fallback = &builtin_profiles[count_of(builtin_profiles) - 1];
+
+    loaded = true;
+
+    if (f_open(&fp, PROFILE_CONFIG_PATH, FA_READ) != FR_OK)
+    {
+        debug_printf("profiles: no %s, using built-ins\n", PROFILE_CONFIG_PATH);
+        use_builtins();
+        write_builtins();
+        return profile_count;
+    }
+
+    profile_count = 0;
+    while (f_gets(line, sizeof line, &fp))
+    {
+        char *s = trim(line);
+        if (*s == '\0' || *s == '#' || *s == ';')
+            continue;
+
+        if (*s == '[')
+        {
+            char *end = strchr(s, ']');
+            if (!end || profile_count >= MAX_PROFILES)
+            {
+                cur = NULL;
+                continue;
+            }
+            *end = '\0';
+            cur = &profiles[profile_count++];
+            *cur = *fallback;
+            cur->exts[0] = '\0';
+            strncpy(cur->name, trim(s + 1), PROFILE_NAME_LEN - 1);
+            cur->name[PROFILE_NAME_LEN - 1] = '\0';
+            continue;
+        }
+
+        char *eq = strchr(s, '=');
+        if (!cur || !eq)
+            continue;
+        *eq = '\0';
+        set_key(cur, trim(s), trim(eq + 1));
+    }
+    f_close(&fp);
+
+    if (profile_count == 0)
+        use_builtins();
+
+    debug_printf("profiles: %d loaded\n", (int)profile_count);
+    return profile_count;
+}
+
+static bool ext_listed(const char *exts, const char *ext)
+{
+    size_t len = strlen(ext);
+
+    while (*exts)
+    {
+        while (*exts == ' ')
+            exts++;
+
+        size_t n = strcspn(exts, " ");
+        if (n == len && strncasecmp(exts, ext, len) == 0)
+            return true;
+        exts += n;
+    }
+    return false;
+}
+
+/* First profile listing the file's extension, else the last profile
+ * with no extensions at all, else the last one loaded.              */
+const transfer_profile_t *profile_for_file(const char *file_name)
+{
+    if (!loaded)
+        profiles_load();
+
+    const char *dot = strrchr(file_name, '.');
+    const char *ext = dot ? dot + 1 : "";
+    const transfer_profile_t *catch_all = &profiles[profile_count - 1];
+
+    for (size_t i = 0; i < profile_count; i++)
+    {
+        if (*ext && ext_listed(profiles[i].exts, ext))
+            return &profiles[i];
+        if (profiles[i].exts[0] == '\0')
+            catch_all = &profiles[i];
+    }
+    return catch_all;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pacer.h"
+
+#define PROFILE_NAME_LEN 24
+#define PROFILE_EXT_LEN 64 // space separated, no dots: "bas txt"
+#define MAX_PROFILES 8
+#define PROFILE_CONFIG_PATH "0:/pal2tty.cfg"
+
+    typedef struct
+    {
+        char name[PROFILE_NAME_LEN];
+        char exts[PROFILE_EXT_LEN];
+        pace_config_t pace;
+    } transfer_profile_t;
+
+    int profiles_load(void);
+    const transfer_profile_t *profile_for_file(const char *file_name);
+
+#ifdef __cplusplus
+}
+#endif
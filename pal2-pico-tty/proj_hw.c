@@ -8,19 +8,24 @@
 #include "hardware/sync.h" // for save_and_disable_interrupts, restore_interrupts
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pico/binary_info.h"
 #include "hardware/adc.h"
 #include "pico/cyw43_arch.h"
 #include "hardware/uart.h"
 
 #include "proj_hw.h"
+#include "hw_cache.h"
 #include "debug.h"
 
 const uint32_t PIN_LED = 25; // only for Pico
 static bool _picoW = true;
 static bool _led = false;
+static bool _board_cached = false; // configure_hardware_begin() took it from hw_cache
 
+static void _check_pico_w_begin();
 static bool _check_pico_w();
+static bool _read_gpio25();
 
 bool __no_inline_not_in_flash_func(get_bootsel_button)()
 {
@@ -83,6 +88,18 @@ bool reserved_addr(uint8_t addr)
     return (addr & 0x78) == 0 || (addr & 0x78) == 0x78;
 }
 
+static void _i2c_bus_init()
+{
+    // This example will use I2C0 on the default SDA and SCL pins (GP4, GP5 on a Pico)
+    i2c_init(I2C_PORT, I2C_SCAN_HZ);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+    // Make the I2C pins available to picotool
+    bi_decl(bi_2pins_with_func(I2C_SDA, I2C_SCL, GPIO_FUNC_I2C));
+}
+
 int scan_i2c_bus()
 {
 #define VERBOSE 0
@@ -96,14 +113,7 @@ int scan_i2c_bus()
 
     int port = -1;
 
-    // This example will use I2C0 on the default SDA and SCL pins (GP4, GP5 on a Pico)
-    i2c_init(I2C_PORT, 100 * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
-    // Make the I2C pins available to picotool
-    bi_decl(bi_2pins_with_func(I2C_SDA, I2C_SCL, GPIO_FUNC_I2C));
+    _i2c_bus_init();
 
 #if VERBOSE
     printf("\nI2C Bus Scan\n");
@@ -150,12 +160,39 @@ int scan_i2c_bus()
     return port;
 }
 
+/* ----------------------------------------------------------------
+ *  find_oled()
+ *  – the display's I2C address: the cached one if a 1‑byte read
+ *    there is acked, else a full scan_i2c_bus(), which is cached.
+ * ---------------------------------------------------------------- */
+int find_oled(void)
+{
+    int addr = hw_cache_get()->oled_addr;
+
+    if (addr > 0 && !reserved_addr(addr))
+    {
+        uint8_t rxdata;
+        _i2c_bus_init();
+        if (i2c_read_blocking(I2C_PORT, addr, &rxdata, 1, false) >= 0)
+        {
+            debug_printf("I²C device @ 0x%02X as cached\r\n", addr);
+            return addr;
+        }
+        debug_printf("No I²C device @ cached 0x%02X, scanning\r\n", addr);
+    }
+
+    addr = scan_i2c_bus();
+    hw_cache_set_oled(addr);
+    return addr;
+}
+
 void init_ssd1306(int addr, ssd1306_t *disp)
 {
 
 #define SLEEPTIME 25
 
     disp->external_vcc = false;
+    i2c_set_baudrate(I2C_PORT, I2C_OLED_HZ); // the scan ran at I2C_SCAN_HZ
     ssd1306_init(disp, 128, 64, addr, I2C_PORT);
     ssd1306_clear(disp);
     ssd1306_show(disp);
@@ -201,10 +238,42 @@ size_t get_largest_alloc_block_binary2(size_t low, size_t high)
     return best;
 }
 
+/* The board probe's ADC wants BOARD_SETTLE_MS between its first
+ * read and the one that counts; the boot scheduler spends that time
+ * on other things rather than sleeping through it.  If the cache
+ * holds a board type for this very board (same flash unique ID, so
+ * not a flash image copied over from another) and GPIO25 reads as
+ * it did at that probe, the cached answer is taken and this returns
+ * true: no settling needed.                                       */
+bool configure_hardware_begin(void)
+{
+    const hw_cache_t *c = hw_cache_get();
+    pico_unique_board_id_t id;
+
+    pico_get_unique_board_id(&id);
+    _board_cached = (c->board == HW_BOARD_PICO || c->board == HW_BOARD_PICO_W) &&
+                    !memcmp(&id, &c->board_id, sizeof id) && _read_gpio25() == c->board_gpio25;
+    if (_board_cached)
+    {
+        _picoW = c->board == HW_BOARD_PICO_W;
+        return true;
+    }
+    _check_pico_w_begin();
+    return false;
+}
+
+/* configure_hardware_begin() must have run BOARD_SETTLE_MS ago,
+ * unless it returned true. */
 bool configure_hardware()
 {
 
-    _picoW = _check_pico_w();
+    if (!_board_cached)
+    {
+        _picoW = _check_pico_w();
+        pico_unique_board_id_t id;
+        pico_get_unique_board_id(&id);
+        hw_cache_set_board(_picoW ? HW_BOARD_PICO_W : HW_BOARD_PICO, _read_gpio25(), &id);
+    }
     // Pico / Pico W dependencies
     if (_picoW)
     {
@@ -226,18 +295,25 @@ bool configure_hardware()
     return true;
 }
 
-static bool _check_pico_w()
+static void _check_pico_w_begin()
 {
     adc_init();
     adc_gpio_init(29);   // Initialize GPIO29 for ADC
     adc_select_input(3); // ADC3 is GPIO29
-    uint16_t adc_value = adc_read();
-    sleep_ms(100);
-    adc_value = adc_read();
+    (void)adc_read();
+}
 
+static bool _read_gpio25()
+{
     gpio_init(25);
     gpio_set_dir(25, GPIO_IN);
-    bool gpio25_value = gpio_get(25);
+    return gpio_get(25);
+}
+
+static bool _check_pico_w()
+{
+    uint16_t adc_value = adc_read();
+    bool gpio25_value = _read_gpio25();
 
     // Logic:
     // - ADC < ~200 (low voltage) suggests Pico W
@@ -250,6 +326,25 @@ static bool _check_pico_w()
     return false; // Probably Pico
 }
 
+void reset_pal_assert(void)
+{
+    /* reset is active‑low */
+    gpio_set_dir(PAL_RESET_GPIO, GPIO_OUT);
+    gpio_put(PAL_RESET_GPIO, 0);
+}
+
+void reset_pal_release(void)
+{
+    gpio_set_dir(PAL_RESET_GPIO, GPIO_IN);
+}
+
+void reset_pal(void)
+{
+    reset_pal_assert();
+    sleep_ms(PAL_RESET_MS);
+    reset_pal_release();
+}
+
 void _set_led(bool flag)
 {
     if (_picoW)
@@ -32,13 +32,20 @@ extern "C"
 #define I2C_PORT i2c0
 #define I2C_SDA 20
 #define I2C_SCL 21
+#define I2C_SCAN_HZ (100 * 1000) // probe unknown devices gently
+#define I2C_OLED_HZ (400 * 1000) // SSD1306 Fast-mode limit
 
-    static int BAUD_RATE = 9600;
+    static int BAUD_RATE = 9600; // at boot; PAL BAUD in the menu moves the PAL and PAL_UART
 
 #define PAL_RESET_GPIO 16
+#define PAL_RESET_MS 100    // reset held this long
+#define BOARD_SETTLE_MS 100 // Pico / Pico W probe: ADC settling
 #define TTY_SWITCH2_OUTPUT 14
 #define TTY_SWITCH1_INPUT 15 /* reserved – not used in this port           */
 
+#define TAPE_OUT_GPIO 17 // FSK to the PAL's audio tape input, via a divider
+#define TAPE_IN_GPIO 18  // the PAL's audio tape output, squared up by a comparator
+
 #define PAL_UART uart0
 #define PAL_UART_TX_GPIO 0
 #define PAL_UART_RX_GPIO 1
@@ -47,10 +54,15 @@ extern "C"
     void test_button(void);
 
     int scan_i2c_bus(void);
+    int find_oled(void);
     void init_ssd1306(int addr, ssd1306_t *p);
     size_t get_largest_alloc_block_binary2(size_t low, size_t high);
 
+    bool configure_hardware_begin(void);
     bool configure_hardware(void);
+    void reset_pal_assert(void);
+    void reset_pal_release(void);
+    void reset_pal(void);
 
     void _error_blink(int count);
     void _toggle_led();
@@ -0,0 +1,370 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#include "ptp_io.h"
+#include "uart_bridge.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define DUMP_TAP_SIZE 1024
+#define DUMP_MAX_GAP 256 // zero‑fill a hole this big between records
+#define DUMP_MAX_FILES 10000
+
+static const char *ext_of(const char *file_name)
+{
+    const char *dot = strrchr(file_name, '.');
+    return dot ? dot + 1 : "";
+}
+
+int ptp_source_mode(const char *file_name)
+{
+    const char *ext = ext_of(file_name);
+
+    if (!strcasecmp(ext, "ptp") || !strcasecmp(ext, "pap") || !strcasecmp(ext, "kim"))
+        return PTP_SRC_TAPE;
+    if (!strcasecmp(ext, "bin") || !strcasecmp(ext, "prg"))
+        return PTP_SRC_BIN;
+    if (!strcasecmp(ext, "hex") || !strcasecmp(ext, "ihx") ||
+        !strcasecmp(ext, "s19") || !strcasecmp(ext, "s28") || !strcasecmp(ext, "s37") ||
+        !strcasecmp(ext, "srec") || !strcasecmp(ext, "mot"))
+        return PTP_SRC_HEX;
+    return PTP_SRC_TEXT;
+}
+
+/* "game@0300.bin" loads at $0300; anything else at PTP_BIN_LOAD_ADDR */
+uint16_t ptp_bin_load_addr(const char *file_name)
+{
+    const char *at = strchr(file_name, '@');
+    return at ? (uint16_t)strtoul(at + 1, NULL, 16) : PTP_BIN_LOAD_ADDR;
+}
+
+void ptp_source_open(ptp_source_t *s, file_stream_t *fs, const char *file_name)
+{
+    memset(s, 0, sizeof *s);
+    s->fs = fs;
+    s->mode = ptp_source_mode(file_name);
+
+    ptp_parser_init(&s->parser);
+    hex_parser_init(&s->hex);
+    ptp_encoder_init(&s->enc, ptp_bin_load_addr(file_name),
+                     s->mode == PTP_SRC_HEX ? PTP_MERGE_BYTES : PTP_DUMP_BYTES);
+
+    /* .prg carries its load address in the first two bytes */
+    s->header_done = strcasecmp(ext_of(file_name), "prg") != 0;
+}
+
+/* Next checked record, or the end record (made up if the tape has
+ * none, or the monitor's L command would hang).  A bad record is
+ * never sent: the end record goes in its place, counting the records
+ * that did go out, so L finishes instead of waiting.               */
+static void refill_tape(ptp_source_t *s)
+{
+    int c;
+
+    s->len = s->pos = 0;
+    while ((c = file_stream_getc(s->fs)) >= 0)
+    {
+        int st = ptp_parse_char(&s->parser, (char)c);
+        if (st == PTP_NONE)
+            continue;
+
+        if (st < 0)
+        {
+            s->err = st;
+            s->err_record = s->parser.records + 1;
+            debug_printf("ptp: record %lu: %s\n", (unsigned long)s->err_record, ptp_strerror(st));
+            break;
+        }
+
+        s->len = ptp_format(&s->parser.rec, s->line);
+        s->done = st == PTP_END;
+        return;
+    }
+
+    ptp_record_t end = {.len = 0, .addr = (uint16_t)s->parser.records};
+    if (!s->err)
+        debug_printf("ptp: no end record, adding one for %lu records\n", (unsigned long)s->parser.records);
+    s->len = ptp_format(&end, s->line);
+    s->done = true;
+}
+
+static void refill_bin(ptp_source_t *s)
+{
+    int c;
+
+    s->len = s->pos = 0;
+    if (!s->header_done)
+    {
+        int lo = file_stream_getc(s->fs);
+        int hi = file_stream_getc(s->fs);
+        if (lo >= 0 && hi >= 0)
+            s->enc.addr = (uint16_t)(hi << 8 | lo);
+        s->header_done = true;
+    }
+
+    while ((c = file_stream_getc(s->fs)) >= 0)
+    {
+        s->len = ptp_encode_byte(&s->enc, (uint8_t)c, s->line);
+        if (s->len)
+            return;
+    }
+
+    s->len = ptp_encode_end(&s->enc, s->line);
+    s->done = true;
+}
+
+/* Next line of the file into hex_line and through the parser.  -1
+ * (as HEX_ERR_SYNTAX) for an over‑long line, HEX_END at end of file.
+ * An over‑long line never reaches hex_parse_line(), so it is counted
+ * here for err_record.                                              */
+static int next_hex_line(ptp_source_t *s)
+{
+    size_t n = 0;
+    int c;
+
+    while ((c = file_stream_getc(s->fs)) >= 0 && c != '\n')
+    {
+        if (n == sizeof s->hex_line)
+        {
+            s->hex.lines++;
+            return HEX_ERR_SYNTAX;
+        }
+        s->hex_line[n++] = (char)c;
+    }
+    if (c < 0 && n == 0)
+        return HEX_END; // a file without its end record still loads
+    return hex_parse_line(&s->hex, s->hex_line, n, &s->hex_rec);
+}
+
+/* Punch the data of each HEX/S‑record line.  Input records are
+ * typically 16 or 32 bytes; the encoder runs on across them until a
+ * record is PTP_MERGE_BYTES long or the address jumps.              */
+static void refill_hex(ptp_source_t *s)
+{
+    s->len = s->pos = 0;
+
+    while (true)
+    {
+        while (s->hex_pos < s->hex_rec.len)
+        {
+            if (s->hex_pos == 0)
+            {
+                s->len = ptp_encode_seek(&s->enc, (uint16_t)s->hex_rec.addr, s->line);
+                if (s->len)
+                    return;
+            }
+            s->len = ptp_encode_byte(&s->enc, s->hex_rec.data[s->hex_pos++], s->line);
+            if (s->len)
+                return;
+        }
+
+        int st = next_hex_line(s);
+        if (st == HEX_DATA)
+        {
+            s->hex_pos = 0;
+            continue;
+        }
+        if (st < 0)
+        {
+            /* what came before the bad line still goes out, then the end */
+            s->err = st;
+            s->err_record = s->hex.lines;
+            s->len = ptp_encode_end(&s->enc, s->line);
+            s->done = true;
+            debug_printf("hex: line %lu: %s\n", (unsigned long)s->err_record, hex_strerror(st));
+            return;
+        }
+        if (st == HEX_END)
+        {
+            s->len = ptp_encode_end(&s->enc, s->line);
+            s->done = true;
+            debug_printf("hex: %lu records in, %lu out\n",
+                         (unsigned long)s->hex.records, (unsigned long)s->enc.records);
+            return;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  ptp_source_getc()
+ *  – next byte for the PAL, or -1 at the end.  After a bad record
+ *    (s->err says which) the end record still goes out, so -1 comes
+ *    once L has been closed.  Tapes go out a whole checked record
+ *    at a time; binaries are punched one record ahead of the UART.
+ * ---------------------------------------------------------------- */
+int ptp_source_getc(ptp_source_t *s)
+{
+    if (s->mode == PTP_SRC_TEXT)
+        return file_stream_getc(s->fs);
+
+    while (s->pos >= s->len)
+    {
+        if (s->done)
+            return -1;
+        if (s->mode == PTP_SRC_TAPE)
+            refill_tape(s);
+        else if (s->mode == PTP_SRC_HEX)
+            refill_hex(s);
+        else
+            refill_bin(s);
+    }
+    return (uint8_t)s->line[s->pos++];
+}
+
+/* Data records handed out so far, the end record not counted. */
+uint32_t ptp_source_records(const ptp_source_t *s)
+{
+    return s->mode == PTP_SRC_TAPE ? s->parser.records : s->enc.records;
+}
+
+const char *ptp_source_strerror(const ptp_source_t *s)
+{
+    return s->mode == PTP_SRC_HEX ? hex_strerror(s->err) : ptp_strerror(s->err);
+}
+
+/* ---- Q dump capture ---------------------------------------------- */
+
+static uint8_t dump_storage[DUMP_TAP_SIZE];
+static bridge_tap_t dump_tap;
+static ptp_parser_t dump_parser;
+static FIL dump_fp;
+static bool dump_open;
+static dump_report_t dump;
+
+static void dump_fail(int err, FRESULT fr)
+{
+    if (dump.err == 0 && dump.fr == FR_OK)
+    {
+        dump.err = err;
+        dump.fr = fr;
+        debug_printf("dump: %s, fr %d\n", ptp_strerror(err), fr);
+    }
+}
+
+static void dump_write(const void *p, UINT n)
+{
+    UINT bw = 0;
+    FRESULT fr = f_write(&dump_fp, p, n, &bw);
+    if (fr == FR_OK && bw < n)
+        fr = FR_DENIED;
+    if (fr != FR_OK)
+        dump_fail(0, fr);
+    dump.bytes += bw;
+}
+
+static bool dump_create(uint16_t addr)
+{
+    FILINFO fno;
+    FRESULT fr = FR_DENIED;
+
+    for (unsigned n = 0; n < DUMP_MAX_FILES; n++)
+    {
+        snprintf(dump.path, sizeof dump.path, DUMP_PATH_FMT, n);
+        fr = f_stat(dump.path, &fno);
+        if (fr != FR_OK)
+            break;
+    }
+    if (fr == FR_OK)
+        fr = FR_DENIED; // every name taken
+    if (fr == FR_NO_FILE)
+        fr = f_open(&dump_fp, dump.path, FA_WRITE | FA_CREATE_NEW);
+    if (fr != FR_OK)
+    {
+        dump_fail(0, fr);
+        return false;
+    }
+
+    uint8_t le[2] = {addr & 0xFF, addr >> 8};
+    dump_open = true;
+    dump.first = dump.next = addr;
+    dump_write(le, sizeof le);
+    dump.bytes = 0; // count image bytes only
+    return true;
+}
+
+static void dump_record(const ptp_record_t *r)
+{
+    static const uint8_t zeros[16];
+
+    if (!dump_open && !dump_create(r->addr))
+        return;
+
+    /* The monitor dumps one range in order; allow small holes from a
+     * hand‑edited tape, anything else is not one image.             */
+    uint16_t gap = r->addr - dump.next;
+    if (gap > DUMP_MAX_GAP)
+    {
+        dump_fail(PTP_ERR_ADDR, FR_OK);
+        return;
+    }
+    while (gap)
+    {
+        uint16_t n = MIN(gap, sizeof zeros);
+        dump_write(zeros, n);
+        gap -= n;
+    }
+
+    dump_write(r->data, r->len);
+    dump.next = r->addr + r->len;
+    dump.records++;
+}
+
+/* ----------------------------------------------------------------
+ *  ptp_dump_begin() / ptp_dump_poll() / ptp_dump_end()
+ *  – turn the tape the PAL punches for "Q" back into a .prg on the
+ *    card.  poll() returns true once the end record (or an error)
+ *    has come in; end() closes up, also after a cancel.
+ * ---------------------------------------------------------------- */
+void ptp_dump_begin(void)
+{
+    memset(&dump, 0, sizeof dump);
+    ptp_parser_init(&dump_parser);
+    dump_open = false;
+
+    if (!uart_bridge_tap_attach(&dump_tap, dump_storage, sizeof dump_storage))
+        dump_fail(0, FR_TOO_MANY_OPEN_FILES);
+}
+
+bool ptp_dump_poll(dump_report_t *out)
+{
+    uint8_t c;
+
+    while (!dump.finished && dump.err == 0 && dump.fr == FR_OK &&
+           spsc_ring_pop(&dump_tap.ring, &c))
+    {
+        int st = ptp_parse_char(&dump_parser, (char)c);
+        if (st == PTP_RECORD)
+            dump_record(&dump_parser.rec);
+        else if (st == PTP_END)
+            dump.finished = true;
+        else if (st < 0)
+            dump_fail(st, FR_OK);
+    }
+
+    if (out)
+        *out = dump;
+    return dump.finished || dump.err != 0 || dump.fr != FR_OK;
+}
+
+void ptp_dump_end(dump_report_t *out)
+{
+    uart_bridge_tap_detach(&dump_tap);
+
+    if (dump_open)
+    {
+        FRESULT fr = f_close(&dump_fp);
+        if (fr != FR_OK)
+            dump_fail(0, fr);
+        dump_open = false;
+    }
+
+    debug_printf("dump: %s %lu records, %lu bytes $%04X-$%04X%s\n", dump.path,
+                 (unsigned long)dump.records, (unsigned long)dump.bytes,
+                 dump.first, (uint16_t)(dump.next - 1), dump.finished ? "" : " (unfinished)");
+    if (out)
+        *out = dump;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "kim_ptp.h"
+#include "hex_records.h"
+#include "file_stream.h"
+
+#define PTP_BIN_LOAD_ADDR 0x0200 // .bin without "@AAAA" in its name
+#define DUMP_PATH_FMT "0:/dump%04u.prg"
+#define DUMP_NAME_LEN 20
+
+    enum
+    {
+        PTP_SRC_TEXT, // not a tape: pass the file through untouched
+        PTP_SRC_TAPE, // .ptp: check every record before it goes out
+        PTP_SRC_BIN,  // .bin/.prg: punch the tape on the fly
+        PTP_SRC_HEX,  // Intel HEX / S‑records: re‑punched as long records
+    };
+
+    /* Upload side: what send_file() pulls its bytes from. */
+    typedef struct
+    {
+        file_stream_t *fs;
+        uint8_t mode;
+        ptp_parser_t parser;
+        ptp_encoder_t enc;
+        char line[2 * PTP_LINE_MAX];
+        size_t len, pos;
+        bool header_done; // .prg load address read
+        hex_parser_t hex;
+        hex_data_t hex_rec;   // being punched
+        uint16_t hex_pos;     // next byte of hex_rec
+        char hex_line[HEX_LINE_MAX];
+        bool done;
+        int err;          // PTP_ERR_*, or HEX_ERR_* in PTP_SRC_HEX; 0 if none
+        uint32_t err_record; // record, or line in PTP_SRC_HEX
+    } ptp_source_t;
+
+    typedef struct
+    {
+        char path[DUMP_NAME_LEN];
+        uint16_t first, next; // address range written so far
+        uint32_t records;
+        uint32_t bytes;
+        int err;              // PTP_ERR_*, 0 if none
+        FRESULT fr;
+        bool finished;        // the end record came in
+    } dump_report_t;
+
+    int ptp_source_mode(const char *file_name);
+    uint16_t ptp_bin_load_addr(const char *file_name);
+    void ptp_source_open(ptp_source_t *s, file_stream_t *fs, const char *file_name);
+    int ptp_source_getc(ptp_source_t *s);
+    uint32_t ptp_source_records(const ptp_source_t *s);
+    const char *ptp_source_strerror(const ptp_source_t *s);
+
+    void ptp_dump_begin(void);
+    bool ptp_dump_poll(dump_report_t *out);
+    void ptp_dump_end(dump_report_t *out);
+
+#ifdef __cplusplus
+}
+#endif
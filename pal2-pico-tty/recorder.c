@@ -0,0 +1,185 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "recorder.h"
+#include "uart_bridge.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define RECORD_RING_SIZE (32 * 1024)       // ~3 s of 115200 baud, power of two
+#define RECORD_MAX_CHUNK (RECORD_RING_SIZE / 4)
+#define RECORD_PREALLOC (1024 * 1024)     // contiguous run reserved up front
+#define RECORD_MAX_FILES 10000
+
+static uint8_t record_storage[RECORD_RING_SIZE];
+static bridge_tap_t record_tap;
+static FIL record_fp;
+static bool active;
+static uint32_t chunk; // bytes per f_write: a cluster, capped at RECORD_MAX_CHUNK
+static uint64_t start_us;
+static record_report_t report;
+
+static FRESULT next_free_path(char *path)
+{
+    FILINFO fno;
+
+    for (unsigned n = 0; n < RECORD_MAX_FILES; n++)
+    {
+        snprintf(path, RECORD_NAME_LEN, RECORD_PATH_FMT, n);
+        FRESULT fr = f_stat(path, &fno);
+        if (fr == FR_NO_FILE)
+            return FR_OK;
+        if (fr != FR_OK)
+            return fr;
+    }
+    return FR_DENIED;
+}
+
+/* Write n bytes straight out of the ring; the data stays in place
+ * until f_write is done with it.                                   */
+static bool write_out(uint32_t n)
+{
+    while (n)
+    {
+        const uint8_t *p;
+        UINT bw = 0;
+        uint32_t run = MIN(spsc_ring_peek(&record_tap.ring, &p), n);
+
+        uint64_t t0 = time_us_64();
+        FRESULT fr = f_write(&record_fp, p, run, &bw);
+        uint32_t dt = (uint32_t)(time_us_64() - t0);
+
+        report.max_write_us = MAX(report.max_write_us, dt);
+        report.bytes += bw;
+        spsc_ring_consume(&record_tap.ring, bw);
+        n -= bw;
+
+        if (fr != FR_OK || bw < run)
+        {
+            report.err = fr != FR_OK ? fr : FR_DENIED; // disk full
+            debug_printf("recorder: f_write error %d\n", report.err);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ----------------------------------------------------------------
+ *  recorder_start()
+ *  – open the next free RECORD_PATH_FMT file, reserve a contiguous
+ *    run for it and start copying PAL output into the ring.
+ * ---------------------------------------------------------------- */
+FRESULT recorder_start(void)
+{
+    FRESULT fr;
+
+    if (active)
+        return FR_OK;
+
+    memset(&report, 0, sizeof report);
+    report.ring_size = RECORD_RING_SIZE;
+
+    fr = next_free_path(report.path);
+    if (fr == FR_OK)
+        fr = f_open(&record_fp, report.path, FA_WRITE | FA_CREATE_NEW);
+    if (fr != FR_OK)
+    {
+        debug_printf("recorder: cannot create %s: %d\n", report.path, fr);
+        return fr;
+    }
+
+    /* Chunks are whole clusters (or an even share of one) and the
+     * file starts on a cluster, so every f_write except the last goes
+     * to the card as one multi-sector transfer with no FAT lookups. */
+    chunk = MIN((uint32_t)record_fp.obj.fs->csize * FF_MAX_SS, RECORD_MAX_CHUNK);
+
+    report.preallocated = f_expand(&record_fp, RECORD_PREALLOC, 1) == FR_OK;
+    if (!report.preallocated)
+        debug_printf("recorder: no contiguous %u bytes, growing as we go\n", RECORD_PREALLOC);
+
+    if (!uart_bridge_tap_attach(&record_tap, record_storage, sizeof record_storage))
+    {
+        debug_printf("recorder: no free tap\n");
+        f_close(&record_fp);
+        f_unlink(report.path);
+        return FR_TOO_MANY_OPEN_FILES;
+    }
+
+    start_us = time_us_64();
+    active = true;
+    debug_printf("recorder: %s, %lu byte chunks\n", report.path, (unsigned long)chunk);
+    return FR_OK;
+}
+
+bool recorder_active(void)
+{
+    return active;
+}
+
+const char *recorder_path(void)
+{
+    return report.path;
+}
+
+/* ----------------------------------------------------------------
+ *  recorder_poll()
+ *  – note how full the ring got and write out every whole chunk.
+ *    Partial chunks wait for more data, so the card only ever sees
+ *    aligned multi-sector writes.  Cheap when there is nothing to do.
+ * ---------------------------------------------------------------- */
+void recorder_poll(void)
+{
+    if (!active || report.err != FR_OK)
+        return;
+
+    uint32_t count = spsc_ring_count(&record_tap.ring);
+    report.peak = MAX(report.peak, count);
+
+    if (count >= chunk)
+        write_out(count - count % chunk);
+}
+
+/* ----------------------------------------------------------------
+ *  recorder_stop()
+ *  – write what is left, give back the unused part of the
+ *    reservation and close the file.
+ * ---------------------------------------------------------------- */
+void recorder_stop(record_report_t *out)
+{
+    if (!active)
+    {
+        if (out)
+            *out = report;
+        return;
+    }
+
+    uart_bridge_tap_detach(&record_tap);
+    active = false;
+
+    if (report.err == FR_OK)
+    {
+        report.peak = MAX(report.peak, spsc_ring_count(&record_tap.ring));
+        write_out(spsc_ring_count(&record_tap.ring));
+    }
+
+    FRESULT fr = f_truncate(&record_fp);
+    if (report.err == FR_OK)
+        report.err = fr;
+    fr = f_close(&record_fp);
+    if (report.err == FR_OK)
+        report.err = fr;
+
+    report.dropped = record_tap.dropped;
+    report.elapsed_us = time_us_64() - start_us;
+
+    debug_printf("recorder: %s %lu bytes, %lu dropped, peak %lu/%lu, slowest write %lu us\n",
+                 report.path, (unsigned long)report.bytes, (unsigned long)report.dropped,
+                 (unsigned long)report.peak, (unsigned long)report.ring_size,
+                 (unsigned long)report.max_write_us);
+
+    if (out)
+        *out = report;
+}
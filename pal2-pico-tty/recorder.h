@@ -0,0 +1,39 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "sd-card/sd-card.h"
+
+#define RECORD_PATH_FMT "0:/rec%04u.cap"
+#define RECORD_NAME_LEN 20
+
+    typedef struct
+    {
+        char path[RECORD_NAME_LEN];
+        uint32_t bytes;       // written to the file
+        uint32_t dropped;     // lost because the ring was full
+        uint32_t peak;        // most bytes waiting in the ring
+        uint32_t ring_size;
+        uint32_t max_write_us; // slowest f_write
+        bool preallocated;    // f_expand found a contiguous run
+        FRESULT err;          // first error, FR_OK if none
+        uint64_t elapsed_us;
+    } record_report_t;
+
+    /* Capture of the PAL->USB stream to the SD card.  Core 1 copies
+     * into a large RAM ring through a bridge tap; core 0 drains it in
+     * whole chunks from recorder_poll(), so a slow card only fills
+     * the ring and never holds up the bridge.                        */
+    FRESULT recorder_start(void);
+    void recorder_stop(record_report_t *out);
+    bool recorder_active(void);
+    const char *recorder_path(void);
+    void recorder_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
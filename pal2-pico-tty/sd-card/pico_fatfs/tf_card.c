@@ -3,7 +3,10 @@
 #include "./fatfs/ff.h"
 #include "./fatfs/diskio.h"
 
+#include <string.h>
+
 #include "pico/stdlib.h"
+#include "hardware/dma.h"
 
 /*--------------------------------------------------------------------------
    SPI and Pin selection
@@ -60,6 +63,26 @@ DSTATUS Stat = STA_NOINIT;  /* Physical drive status */
 static
 BYTE CardType;          /* Card type flags */
 
+static int dma_tx = -1;     /* DMA channels for the 512-byte data phases */
+static int dma_rx = -1;
+static bool use_dma = true;
+
+/*--------------------------------------------------------------------------
+   Read-ahead cache: a run of consecutive sectors [ra_lo, ra_hi), sector s
+   kept in slot s % RA_SECTORS.  Filled by one CMD18 when a sequential read
+   misses and topped up by pico_fatfs_prefetch() while the caller idles.
+---------------------------------------------------------------------------*/
+#define RA_SECTORS  8   /* Window size, power of 2 (4 KB) */
+#define RA_BATCH    2   /* Sectors read per pico_fatfs_prefetch() call */
+
+static BYTE ra_buf[RA_SECTORS][512];
+static LBA_t ra_lo, ra_hi;          /* Cached run, empty when equal */
+static LBA_t ra_last = (LBA_t)-2;   /* Last sector asked for */
+static bool use_readahead = true;
+static pico_fatfs_cache_stats_t ra_stats;
+
+#define RA_SLOT(s)  ra_buf[(s) & (RA_SECTORS - 1)]
+
 static inline uint32_t _millis(void)
 {
     return to_ms_since_boot(get_absolute_time());
@@ -173,6 +196,44 @@ BYTE xchg_spi (
 }
 
 
+/* Move a block through the SPI FIFOs with two DMA channels, one each way.
+   tx == NULL clocks out 0xFF, rx == NULL throws the received bytes away. */
+static
+void dma_spi_xfer (
+    const BYTE *tx,     /* Data to send or NULL */
+    BYTE *rx,           /* Receive buffer or NULL */
+    UINT n              /* Number of bytes */
+)
+{
+    static const BYTE ff = 0xFF;
+    static BYTE sink;
+    spi_hw_t *hw = spi_get_hw(_config.spi_inst);
+
+    if (dma_tx < 0) {   /* First use: claim the channels once */
+        dma_tx = dma_claim_unused_channel(true);
+        dma_rx = dma_claim_unused_channel(true);
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(_config.spi_inst, true));
+    channel_config_set_read_increment(&c, tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(dma_tx, &c, &hw->dr, tx ? tx : &ff, n, false);
+
+    c = dma_channel_get_default_config(dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(_config.spi_inst, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rx != NULL);
+    dma_channel_configure(dma_rx, &c, rx ? rx : &sink, &hw->dr, n, false);
+
+    /* Start both together so the RX FIFO can never overflow */
+    dma_start_channel_mask((1u << dma_tx) | (1u << dma_rx));
+    dma_channel_wait_for_finish_blocking(dma_rx);
+}
+
+
 /* Receive multiple byte */
 static
 void rcvr_spi_multi (
@@ -181,7 +242,11 @@ void rcvr_spi_multi (
 )
 {
     uint8_t *b = (uint8_t *) buff;
-    spi_read_blocking(_config.spi_inst, 0xff, b, btr);
+    if (use_dma) {
+        dma_spi_xfer(NULL, b, btr);
+    } else {
+        spi_read_blocking(_config.spi_inst, 0xff, b, btr);
+    }
 }
 
 
@@ -365,6 +430,8 @@ DSTATUS disk_initialize (
     CardType = ty;  /* Card type */
     deselect();
 
+    ra_lo = ra_hi = 0;  /* Whatever was cached may be from another card */
+
     if (ty) {           /* OK */
         FCLK_FAST();            /* Set fast clock */
         Stat &= ~STA_NOINIT;    /* Clear STA_NOINIT flag */
@@ -396,36 +463,139 @@ DSTATUS disk_status (
 /* Read sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_read (
-    BYTE drv,       /* Physical drive number (0) */
-    BYTE *buff,     /* Pointer to the data buffer to store read data */
+static
+UINT card_read (    /* Number of sectors not read (0:OK) */
+    BYTE *buff,     /* Destination, NULL to fill the read-ahead slots */
     LBA_t sector,   /* Start sector number (LBA) */
-    UINT count      /* Number of sectors to read (1..128) */
+    UINT count      /* Number of sectors to read */
 )
 {
-    if (drv || !count) return RES_PARERR;       /* Check parameter */
-    if (Stat & STA_NOINIT) return RES_NOTRDY;   /* Check if drive is ready */
-
-    if (!(CardType & CT_BLOCK)) sector *= 512;  /* LBA ot BA conversion (byte addressing cards) */
+    LBA_t ba = (CardType & CT_BLOCK) ? sector : sector * 512;  /* LBA ot BA conversion (byte addressing cards) */
 
-    if (count == 1) {   /* Single sector read */
-        if ((send_cmd(CMD17, sector) == 0)  /* READ_SINGLE_BLOCK */
+    if (count == 1 && buff) {   /* Single sector read */
+        if ((send_cmd(CMD17, ba) == 0)  /* READ_SINGLE_BLOCK */
             && rcvr_datablock(buff, 512)) {
             count = 0;
         }
     }
     else {              /* Multiple sector read */
-        if (send_cmd(CMD18, sector) == 0) { /* READ_MULTIPLE_BLOCK */
+        if (send_cmd(CMD18, ba) == 0) { /* READ_MULTIPLE_BLOCK */
             do {
-                if (!rcvr_datablock(buff, 512)) break;
-                buff += 512;
+                if (!rcvr_datablock(buff ? buff : RA_SLOT(sector), 512)) break;
+                if (buff) buff += 512;
+                sector++;
             } while (--count);
             send_cmd(CMD12, 0);             /* STOP_TRANSMISSION */
         }
     }
     deselect();
 
-    return count ? RES_ERROR : RES_OK;  /* Return result */
+    return count;
+}
+
+
+/* Refill the window from sector onward, keeping whatever was read */
+static
+int ra_fill (       /* 1:OK, 0:Error on the first sector */
+    LBA_t sector,
+    UINT count
+)
+{
+    UINT left = card_read(NULL, sector, count);
+
+    if (ra_hi != sector) ra_lo = sector;    /* Not an extension: restart the run */
+    ra_hi = sector + (count - left);        /* Reading past the card end just stops short */
+
+    /* The run may not outgrow the slots; a failed block may also have
+       clobbered the slot after the last good one */
+    UINT keep = left ? RA_SECTORS - 1 : RA_SECTORS;
+    if (ra_hi - ra_lo > keep) ra_lo = ra_hi - keep;
+    return left < count;
+}
+
+
+DRESULT disk_read (
+    BYTE drv,       /* Physical drive number (0) */
+    BYTE *buff,     /* Pointer to the data buffer to store read data */
+    LBA_t sector,   /* Start sector number (LBA) */
+    UINT count      /* Number of sectors to read (1..128) */
+)
+{
+    if (drv || !count) return RES_PARERR;       /* Check parameter */
+    if (Stat & STA_NOINIT) return RES_NOTRDY;   /* Check if drive is ready */
+
+    if (!use_readahead || count >= RA_SECTORS) {    /* Big reads are already one CMD18 */
+        ra_last = sector + count - 1;
+        ra_stats.bypassed += count;
+        return card_read(buff, sector, count) ? RES_ERROR : RES_OK;
+    }
+
+    for ( ; count; count--, sector++, buff += 512) {
+        if (sector >= ra_lo && sector < ra_hi) {
+            ra_stats.hits++;
+        }
+        else if (sector == ra_last + 1) {       /* Sequential: read a window ahead */
+            ra_stats.misses++;
+            if (!ra_fill(sector, RA_SECTORS)) return RES_ERROR;
+        }
+        else {          /* Random (FAT, directory): leave the window alone */
+            ra_stats.misses++;
+            ra_last = sector;
+            if (card_read(buff, sector, 1)) return RES_ERROR;
+            continue;
+        }
+        memcpy(buff, RA_SLOT(sector), 512);
+        ra_lo = sector;                         /* Slots below are free for prefetch */
+        ra_last = sector;
+    }
+
+    return RES_OK;
+}
+
+
+/* Drop cached sectors that overlap a write */
+static
+void ra_invalidate (
+    LBA_t sector,
+    UINT count
+)
+{
+    if (sector < ra_hi && sector + count > ra_lo) ra_lo = ra_hi = 0;
+}
+
+
+void pico_fatfs_prefetch(void)
+{
+    UINT n;
+
+    if (!use_readahead || (Stat & STA_NOINIT) || ra_hi == ra_lo) return;
+
+    n = RA_SECTORS - (UINT)(ra_hi - ra_lo);
+    if (n == 0) return;
+    if (n > RA_BATCH) n = RA_BATCH;
+
+    LBA_t from = ra_hi;
+    if (ra_fill(from, n)) ra_stats.prefetched += (UINT)(ra_hi - from);
+    else ra_lo = ra_hi = 0;                     /* End of card or error: stop reading ahead */
+}
+
+
+void pico_fatfs_set_readahead(bool enable)
+{
+    use_readahead = enable;
+    ra_lo = ra_hi = 0;
+}
+
+
+void pico_fatfs_get_cache_stats(pico_fatfs_cache_stats_t *st)
+{
+    *st = ra_stats;
+}
+
+
+void pico_fatfs_reset_cache_stats(void)
+{
+    memset(&ra_stats, 0, sizeof ra_stats);
 }
 
 
@@ -448,7 +618,11 @@ void xmit_spi_multi (
 )
 {
     const uint8_t *b = (const uint8_t *) buff;
-    spi_write_blocking(_config.spi_inst, b, btx);
+    if (use_dma) {
+        dma_spi_xfer(b, NULL, btx);
+    } else {
+        spi_write_blocking(_config.spi_inst, b, btx);
+    }
 }
 
 /*-----------------------------------------------------------------------*/
@@ -490,6 +664,8 @@ DRESULT disk_write (
     if (Stat & STA_NOINIT) return RES_NOTRDY;   /* Check drive status */
     if (Stat & STA_PROTECT) return RES_WRPRT;   /* Check write protect */
 
+    ra_invalidate(sector, count);
+
     if (!(CardType & CT_BLOCK)) sector *= 512;  /* LBA ==> BA conversion (byte addressing cards) */
 
     if (!_select()) return RES_NOTRDY;
@@ -609,3 +785,8 @@ int pico_fatfs_reboot_spi(void)
 {
     return _select();
 }
+
+void pico_fatfs_set_dma(bool enable)
+{
+    use_dma = enable;
+}
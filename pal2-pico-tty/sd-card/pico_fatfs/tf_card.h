@@ -42,6 +42,37 @@ extern "C" {
 void pico_fatfs_set_config(pico_fatfs_spi_config_t *config);
 int pico_fatfs_reboot_spi(void);
 
+/**
+* Select DMA (default) or blocking SPI for the 512-byte data phases
+*
+* @param[in] enable true to use DMA
+*/
+void pico_fatfs_set_dma(bool enable);
+
+typedef struct {
+    uint32_t hits;          /* sectors served from the read-ahead window */
+    uint32_t misses;        /* sectors that had to wait for the card */
+    uint32_t prefetched;    /* sectors read ahead by pico_fatfs_prefetch() */
+    uint32_t bypassed;      /* sectors in reads too big to be worth caching */
+} pico_fatfs_cache_stats_t;
+
+/**
+* Top up the read-ahead window by a few sectors.  Cheap when there is
+* nothing to do; call it whenever the caller is about to wait anyway.
+* Must not be called while FatFs is inside a disk_* call.
+*/
+void pico_fatfs_prefetch(void);
+
+/**
+* Enable (default) or disable the read-ahead cache; either way it is emptied
+*
+* @param[in] enable true to read ahead
+*/
+void pico_fatfs_set_readahead(bool enable);
+
+void pico_fatfs_get_cache_stats(pico_fatfs_cache_stats_t *st);
+void pico_fatfs_reset_cache_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -12,8 +12,6 @@
 #include "proj_hw.h"
 #include "debug.h"
 
-#define RUN_PERF_TEST false
-
 // Set PRE_ALLOCATE true to pre-allocate file clusters.
 const bool PRE_ALLOCATE = true;
 
@@ -25,8 +23,10 @@ const bool SKIP_FIRST_LATENCY = true;
 // const size_t BUF_SIZE = 512;
 #define BUF_SIZE 512
 
-// File size in MB where MB = 1,000,000 bytes.
-const uint32_t FILE_SIZE_MB = 5;
+// File size in MB where MB = 1,000,000 bytes.  Kept small so the
+// benchmark page (both modes, WRITE_COUNT + READ_COUNT passes each)
+// finishes in well under a minute.
+const uint32_t FILE_SIZE_MB = 1;
 
 // Write pass count.
 const uint8_t WRITE_COUNT = 2;
@@ -71,36 +71,25 @@ static pico_fatfs_spi_config_t config = {
 };
 
 static FATFS fs;
+static bool mounted;
+
+bool sd_card_mounted(void)
+{
+    return mounted;
+}
 
+/* ----------------------------------------------------------------
+ *  prep_sd_card()
+ *  – mount the card on first use; after that a no‑op.  Returns the
+ *    FRESULT of the mount, so a missing card is an error the caller
+ *    shows rather than a hang at boot.
+ * ---------------------------------------------------------------- */
 int prep_sd_card()
 {
-    FIL fil;
     FRESULT fr; /* FatFs return code */
-    UINT br;
-    UINT bw;
-
-    float s;
-    uint32_t t;
-    uint32_t maxLatency;
-    uint32_t minLatency;
-    uint32_t totalLatency;
-    bool skipLatency;
-
-#if RUN_PERF_TEST
-    printf("Type any character to start\n");
-    while (true)
-    {
-        int ch_usb = getchar_timeout_us(0);
-        if (ch_usb != PICO_ERROR_TIMEOUT)
-        {
-            break;
-            // uart_putc_raw(PAL_UART, (uint8_t)ch_usb);
-        }
-    }
-#endif
 
-    // printf("Type any character to start\n");
-    // while (!uart_is_readable_within_us(uart0, 1000));
+    if (mounted)
+        return FR_OK;
 
 #if 0
     printf("=====================\n");
@@ -123,8 +112,9 @@ int prep_sd_card()
     if (fr != FR_OK)
     {
         printf("mount error %d\n", fr);
-        _error_blink(1);
+        return fr;
     }
+    mounted = true;
     debug_printf("mount ok\n");
 
     switch (fs.fs_type)
@@ -159,141 +149,122 @@ int prep_sd_card()
     printf("Manufacturing date : %d/%d\n\n", (int) cid[14] & 0xf, ((int) cid[13] & 0xf)*16 + ((int) (cid[14] >> 2) & 0xf) + 2000);
 #endif
 
-#if RUN_PERF_TEST
-    fr = f_open(&fil, "bench.dat", FA_READ | FA_WRITE | FA_CREATE_ALWAYS);
-    if (fr != FR_OK)
+#if 0
+    DirEntry *root = NULL;
+
+    if (build_tree(DRIVE_PATH PTP_PATH, &root, true) == FR_OK)
     {
-        printf("open error %d\n", fr);
-        _error_blink(2);
+        print_tree(root, 0);
+        // Work with `root` as needed...
+        free_tree(root);
     }
+#endif
 
-    // fill buf with known data
-    if (BUF_SIZE > 1)
+    return 0;
+}
+
+/* ----------------------------------------------------------------
+ *  Speed test, once the old RUN_PERF_TEST block.  Each pass writes
+ *  then reads back FILE_SIZE bytes of BENCH_PATH; the best of
+ *  WRITE_COUNT / READ_COUNT passes is kept.
+ * ---------------------------------------------------------------- */
+static void bench_start(sd_bench_pass_t *pass)
+{
+    pass->kb_per_s = 0;
+    pass->max_us = 0;
+    pass->min_us = UINT32_MAX;
+    pass->avg_us = 0;
+}
+
+static void bench_keep_best(sd_bench_pass_t *best, const sd_bench_pass_t *pass)
+{
+    if (pass->kb_per_s > best->kb_per_s)
     {
-        for (size_t i = 0; i < (BUF_SIZE - 2); i++)
-        {
-            buf[i] = 'A' + (i % 26);
-        }
-        buf[BUF_SIZE - 2] = '\r';
+        *best = *pass;
     }
-    buf[BUF_SIZE - 1] = '\n';
-
-    printf("FILE_SIZE_MB = %d\n", FILE_SIZE_MB);
-    printf("BUF_SIZE = %d bytes\n", BUF_SIZE);
-    printf("Starting write test, please wait.\n\n");
+}
 
-    // do write test
+static FRESULT bench_write(FIL *fil, sd_bench_pass_t *best)
+{
+    FRESULT fr;
+    UINT bw;
     uint32_t n = FILE_SIZE / BUF_SIZE;
-    printf("write speed and latency\n");
-    printf("speed,max,min,avg\n");
-    printf("KB/Sec,usec,usec,usec\n");
+
     for (uint8_t nTest = 0; nTest < WRITE_COUNT; nTest++)
     {
-        fr = f_lseek(&fil, 0);
-        if (fr != FR_OK)
-        {
-            printf("lseek error %d\n", fr);
-            _error_blink(3);
-        }
-        fr = f_truncate(&fil);
-        if (fr != FR_OK)
-        {
-            printf("truncate error %d\n", fr);
-            _error_blink(4);
-        }
-        if (PRE_ALLOCATE)
-        {
-            fr = f_expand(&fil, FILE_SIZE, 0);
-            if (fr != FR_OK)
-            {
-                printf("preallocate error %d\n", fr);
-                _error_blink(5);
-            }
-        }
-        maxLatency = 0;
-        minLatency = 9999999;
-        totalLatency = 0;
-        skipLatency = SKIP_FIRST_LATENCY;
-        t = to_ms_since_boot(get_absolute_time());
+        sd_bench_pass_t pass;
+        uint32_t totalLatency = 0;
+        bool skipLatency = SKIP_FIRST_LATENCY;
+
+        bench_start(&pass);
+        if ((fr = f_lseek(fil, 0)) != FR_OK || (fr = f_truncate(fil)) != FR_OK)
+            return fr;
+        if (PRE_ALLOCATE && (fr = f_expand(fil, FILE_SIZE, 0)) != FR_OK)
+            return fr;
+
+        uint64_t t = time_us_64();
         for (uint32_t i = 0; i < n; i++)
         {
-            uint32_t m = to_us_since_boot(get_absolute_time());
-            fr = f_write(&fil, buf, BUF_SIZE, &bw);
+            uint32_t m = time_us_32();
+            fr = f_write(fil, buf, BUF_SIZE, &bw);
             if (fr != FR_OK || bw != BUF_SIZE)
-            {
-                printf("write failed %d %d\n", fr, bw);
-                _error_blink(6);
-            }
-            m = to_us_since_boot(get_absolute_time()) - m;
+                return fr != FR_OK ? fr : FR_DISK_ERR;
+            m = time_us_32() - m;
             totalLatency += m;
             if (skipLatency)
             {
                 // Wait until first write to SD, not just a copy to the cache.
-                skipLatency = f_tell(&fil) < 512;
+                skipLatency = f_tell(fil) < 512;
             }
             else
             {
-                if (maxLatency < m)
-                {
-                    maxLatency = m;
-                }
-                if (minLatency > m)
-                {
-                    minLatency = m;
-                }
+                pass.max_us = MAX(pass.max_us, m);
+                pass.min_us = MIN(pass.min_us, m);
             }
             if (i % 10 == 0)
                 _toggle_led();
         }
-        fr = f_sync(&fil);
-        if (fr != FR_OK)
-        {
-            printf("f_sync failed %d\n", fr);
-            _error_blink(7);
-        }
-        t = to_ms_since_boot(get_absolute_time()) - t;
-        s = f_size(&fil);
-        printf("%7.4f, %d, %d, %d\n", s / t, maxLatency, minLatency, totalLatency / n);
+        if ((fr = f_sync(fil)) != FR_OK)
+            return fr;
+        t = time_us_64() - t;
+
+        pass.kb_per_s = (uint32_t)((uint64_t)f_size(fil) * 1000 / t);
+        pass.avg_us = totalLatency / n;
+        bench_keep_best(best, &pass);
     }
-#endif
+    return FR_OK;
+}
 
-#if RUN_PERF_TEST
-    printf("\n");
-    printf("Starting read test, please wait.\n\n");
-    printf("read speed and latency\n");
-    printf("speed,max,min,avg\n");
-    printf("KB/Sec,usec,usec,usec\n");
+static FRESULT bench_read(FIL *fil, sd_bench_pass_t *best)
+{
+    FRESULT fr;
+    UINT br;
+    uint32_t n = FILE_SIZE / BUF_SIZE;
 
-    // do read test
     for (uint8_t nTest = 0; nTest < READ_COUNT; nTest++)
     {
-        fr = f_rewind(&fil);
-        if (fr != FR_OK)
-        {
-            printf("rewind failed %d\n", fr);
-            _error_blink(8);
-        }
-        maxLatency = 0;
-        minLatency = 9999999;
-        totalLatency = 0;
-        skipLatency = SKIP_FIRST_LATENCY;
-        t = to_ms_since_boot(get_absolute_time());
+        sd_bench_pass_t pass;
+        uint32_t totalLatency = 0;
+        bool skipLatency = SKIP_FIRST_LATENCY;
+
+        bench_start(&pass);
+        if ((fr = f_rewind(fil)) != FR_OK)
+            return fr;
+
+        uint64_t t = time_us_64();
         for (uint32_t i = 0; i < n; i++)
         {
             buf[BUF_SIZE - 1] = 0;
-            uint32_t m = to_us_since_boot(get_absolute_time());
-            fr = f_read(&fil, buf, BUF_SIZE, &br);
+            uint32_t m = time_us_32();
+            fr = f_read(fil, buf, BUF_SIZE, &br);
             if (fr != FR_OK || br != BUF_SIZE)
-            {
-                printf("read failed %d %d\n", fr, br);
-                _error_blink(9);
-            }
-            m = to_us_since_boot(get_absolute_time()) - m;
+                return fr != FR_OK ? fr : FR_DISK_ERR;
+            m = time_us_32() - m;
             totalLatency += m;
             if (buf[BUF_SIZE - 1] != '\n')
             {
-                printf("data check error");
-                _error_blink(10);
+                debug_printf("data check error\n");
+                return FR_INT_ERR;
             }
             if (skipLatency)
             {
@@ -301,39 +272,274 @@ int prep_sd_card()
             }
             else
             {
-                if (maxLatency < m)
-                {
-                    maxLatency = m;
-                }
-                if (minLatency > m)
-                {
-                    minLatency = m;
-                }
+                pass.max_us = MAX(pass.max_us, m);
+                pass.min_us = MIN(pass.min_us, m);
             }
             if (i % 10 == 0)
                 _toggle_led();
         }
-        t = to_ms_since_boot(get_absolute_time()) - t;
-        s = f_size(&fil);
-        printf("%7.4f, %d, %d, %d\n", s / t, maxLatency, minLatency, totalLatency / n);
+        t = time_us_64() - t;
+
+        pass.kb_per_s = (uint32_t)((uint64_t)f_size(fil) * 1000 / t);
+        pass.avg_us = totalLatency / n;
+        bench_keep_best(best, &pass);
     }
+    return FR_OK;
+}
+
+/* ----------------------------------------------------------------
+ *  sd_card_benchmark()
+ *  – run the write/read test with blocking SPI, then with DMA, so
+ *    both columns come from the same card, file and clusters.
+ *    Leaves DMA enabled.  Returns FR_OK or the first FatFs error.
+ * ---------------------------------------------------------------- */
+FRESULT sd_card_benchmark(sd_bench_t *out)
+{
+    FIL fil;
+    FRESULT fr;
+
+    memset(out, 0, sizeof *out);
+
+    // fill buf with known data
+    if (BUF_SIZE > 1)
+    {
+        for (size_t i = 0; i < (BUF_SIZE - 2); i++)
+        {
+            buf[i] = 'A' + (i % 26);
+        }
+        buf[BUF_SIZE - 2] = '\r';
+    }
+    buf[BUF_SIZE - 1] = '\n';
+
+    fr = f_open(&fil, BENCH_PATH, FA_READ | FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+    {
+        debug_printf("bench: open error %d\n", fr);
+        return fr;
+    }
+
+    for (int mode = SD_BENCH_SPI; mode <= SD_BENCH_DMA && fr == FR_OK; mode++)
+    {
+        pico_fatfs_set_dma(mode == SD_BENCH_DMA);
+        fr = bench_write(&fil, &out->write[mode]);
+        pico_fatfs_reset_cache_stats();
+        if (fr == FR_OK)
+            fr = bench_read(&fil, &out->read[mode]);
+
+        pico_fatfs_cache_stats_t cache;
+        pico_fatfs_get_cache_stats(&cache);
+        debug_printf("bench: sector cache %lu hit, %lu miss\n",
+                     (unsigned long)cache.hits, (unsigned long)cache.misses);
+
+        debug_printf("bench %s: write %lu KB/s max %lu us, read %lu KB/s max %lu us\n",
+                     mode == SD_BENCH_DMA ? "DMA" : "SPI",
+                     (unsigned long)out->write[mode].kb_per_s, (unsigned long)out->write[mode].max_us,
+                     (unsigned long)out->read[mode].kb_per_s, (unsigned long)out->read[mode].max_us);
+    }
+    pico_fatfs_set_dma(true);
 
     f_close(&fil);
-    printf("\nDone\n");
-#endif
+    f_unlink(BENCH_PATH);
+    _set_led(false);
 
-#if 0
-    DirEntry *root = NULL;
+    if (fr != FR_OK)
+        debug_printf("bench: error %d\n", fr);
+    return fr;
+}
 
-    if (build_tree(DRIVE_PATH PTP_PATH, &root, true) == FR_OK)
+/* ----------------------------------------------------------------
+ *  Fast‑seek opens.  A read‑only file gets a cluster link map from
+ *  clmt_arena so f_lseek() no longer walks the FAT chain; a file too
+ *  fragmented for its slot, or opened with no slot free, still opens
+ *  and simply seeks the slow way.
+ * ---------------------------------------------------------------- */
+static DWORD clmt_arena[CLMT_SLOTS][CLMT_SLOT_WORDS];
+static FIL *clmt_owner[CLMT_SLOTS];
+
+FRESULT sd_open_fast(FIL *fp, const char *path, BYTE mode)
+{
+    FRESULT fr = f_open(fp, path, mode);
+    if (fr != FR_OK || (mode & FA_WRITE))
+        return fr; // a link map freezes the file size, so read only
+
+    for (int i = 0; i < CLMT_SLOTS; i++)
     {
-        print_tree(root, 0);
-        // Work with `root` as needed...
-        free_tree(root);
+        if (clmt_owner[i])
+            continue;
+
+        DWORD *tbl = clmt_arena[i];
+        tbl[0] = CLMT_SLOT_WORDS;
+        fp->cltbl = tbl;
+
+        FRESULT lr = f_lseek(fp, CREATE_LINKMAP);
+        if (lr == FR_OK)
+        {
+            clmt_owner[i] = fp;
+            return FR_OK;
+        }
+
+        fp->cltbl = NULL;
+        if (lr == FR_NOT_ENOUGH_CORE)
+            debug_printf("clmt: %s needs %lu words, walking the FAT\n", path, (unsigned long)tbl[0]);
+        else
+            debug_printf("clmt: link map error %d on %s\n", lr, path);
+        return FR_OK;
     }
-#endif
 
-    return 0;
+    debug_printf("clmt: no free slot for %s\n", path);
+    return FR_OK;
+}
+
+FRESULT sd_close_fast(FIL *fp)
+{
+    for (int i = 0; i < CLMT_SLOTS; i++)
+    {
+        if (clmt_owner[i] == fp)
+            clmt_owner[i] = NULL;
+    }
+    return f_close(fp);
+}
+
+/* Fragments in an open file with a link map, 0 without one */
+uint32_t sd_file_fragments(const FIL *fp)
+{
+    return fp->cltbl ? fp->cltbl[0] / 2 - 1 : 0;
+}
+
+/* ----------------------------------------------------------------
+ *  Seek test.  One file is pre‑allocated in one piece; the other is
+ *  grown in step with a filler file so it ends up in SEEK_FRAGMENTS
+ *  pieces, whatever the cluster size.  Each is then seeked SEEK_COUNT times to random
+ *  sector‑aligned offsets (no data read), first walking the FAT and
+ *  then through the link map.
+ * ---------------------------------------------------------------- */
+static const char *const SEEK_PATHS[SD_SEEK_FILES] = {
+    "0:/seek_c.dat",
+    "0:/seek_f.dat",
+};
+#define SEEK_FILLER_PATH "0:/seek_x.dat"
+#define SEEK_FILE_SIZE (1024UL * 1024)
+#define SEEK_FRAGMENTS 32 // must fit a CLMT slot
+#define SEEK_COUNT 64
+
+static FRESULT seek_write_run(FIL *fil, UINT run_bytes)
+{
+    FRESULT fr;
+    UINT bw;
+
+    for (UINT done = 0; done < run_bytes; done += BUF_SIZE)
+    {
+        fr = f_write(fil, buf, BUF_SIZE, &bw);
+        if (fr != FR_OK || bw != BUF_SIZE)
+            return fr != FR_OK ? fr : FR_DENIED; // card full
+    }
+    return FR_OK;
+}
+
+static FRESULT seek_make_files(void)
+{
+    FIL fil, filler;
+    FRESULT fr;
+    UINT cluster_bytes = fs.csize * 512;
+    UINT run_bytes = SEEK_FILE_SIZE / SEEK_FRAGMENTS;
+
+    run_bytes = (run_bytes + cluster_bytes - 1) / cluster_bytes * cluster_bytes;
+
+    memset(buf, 0x55, BUF_SIZE);
+
+    fr = f_open(&fil, SEEK_PATHS[SD_SEEK_CONTIG], FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+        return fr;
+    fr = f_expand(&fil, SEEK_FILE_SIZE, 1);
+    f_close(&fil);
+    if (fr != FR_OK)
+        return fr;
+
+    fr = f_open(&fil, SEEK_PATHS[SD_SEEK_FRAG], FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+        return fr;
+    fr = f_open(&filler, SEEK_FILLER_PATH, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+    {
+        f_close(&fil);
+        return fr;
+    }
+    while (fr == FR_OK && f_size(&fil) < SEEK_FILE_SIZE)
+    {
+        fr = seek_write_run(&fil, run_bytes);
+        if (fr == FR_OK)
+            fr = seek_write_run(&filler, cluster_bytes);
+        _toggle_led();
+    }
+    f_close(&filler);
+    f_close(&fil);
+    f_unlink(SEEK_FILLER_PATH);
+    return fr;
+}
+
+static FRESULT seek_time(FIL *fil, sd_seek_time_t *out)
+{
+    uint32_t sectors = f_size(fil) / 512;
+    uint32_t seed = 12345; // same offsets for every run
+    uint32_t total = 0;
+
+    out->max_us = 0;
+    for (int i = 0; i < SEEK_COUNT; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        FSIZE_t pos = (FSIZE_t)((seed >> 8) % sectors) * 512;
+
+        uint32_t m = time_us_32();
+        FRESULT fr = f_lseek(fil, pos);
+        m = time_us_32() - m;
+        if (fr != FR_OK)
+            return fr;
+
+        total += m;
+        out->max_us = MAX(out->max_us, m);
+    }
+    out->avg_us = total / SEEK_COUNT;
+    return FR_OK;
+}
+
+FRESULT sd_seek_benchmark(sd_seek_bench_t *out)
+{
+    FIL fil;
+    FRESULT fr;
+
+    memset(out, 0, sizeof *out);
+
+    fr = seek_make_files();
+    for (int i = 0; i < SD_SEEK_FILES && fr == FR_OK; i++)
+    {
+        fr = f_open(&fil, SEEK_PATHS[i], FA_READ);
+        if (fr != FR_OK)
+            break;
+        fr = seek_time(&fil, &out->walk[i]);
+        f_close(&fil);
+        if (fr != FR_OK)
+            break;
+
+        fr = sd_open_fast(&fil, SEEK_PATHS[i], FA_READ);
+        if (fr != FR_OK)
+            break;
+        out->fragments[i] = sd_file_fragments(&fil);
+        fr = seek_time(&fil, &out->clmt[i]);
+        sd_close_fast(&fil);
+
+        debug_printf("seek %s: %lu frags, walk %lu/%lu us, clmt %lu/%lu us (avg/max)\n",
+                     SEEK_PATHS[i], (unsigned long)out->fragments[i],
+                     (unsigned long)out->walk[i].avg_us, (unsigned long)out->walk[i].max_us,
+                     (unsigned long)out->clmt[i].avg_us, (unsigned long)out->clmt[i].max_us);
+    }
+
+    for (int i = 0; i < SD_SEEK_FILES; i++)
+        f_unlink(SEEK_PATHS[i]);
+    _set_led(false);
+
+    if (fr != FR_OK)
+        debug_printf("seek bench: error %d\n", fr);
+    return fr;
 }
 
 FRESULT build_tree(const char *path, DirEntry **out_node, bool recurse)
@@ -1,3 +1,5 @@
+#pragma once
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -17,6 +19,10 @@ extern "C"
 #define DRIVE_PATH "0:"
 //#define PTP_PATH "/kim-1/basic"
 #define PTP_PATH ""
+#define BENCH_PATH "0:/bench.dat"
+
+#define CLMT_SLOTS 2       // files open with a link map at once
+#define CLMT_SLOT_WORDS 128 // 2 per fragment + 2: up to 63 fragments
 
 
     typedef struct DirEntry
@@ -28,10 +34,57 @@ extern "C"
         struct DirEntry *children; // First child (if is_dir)
     } DirEntry;
 
+    enum
+    {
+        SD_BENCH_SPI, // blocking spi_read/write
+        SD_BENCH_DMA, // data phases moved by DMA
+        SD_BENCH_MODES
+    };
+
+    typedef struct
+    {
+        uint32_t kb_per_s; // KB = 1000 bytes
+        uint32_t max_us;   // per 512-byte f_read/f_write
+        uint32_t min_us;
+        uint32_t avg_us;
+    } sd_bench_pass_t;
+
+    typedef struct
+    {
+        sd_bench_pass_t write[SD_BENCH_MODES];
+        sd_bench_pass_t read[SD_BENCH_MODES];
+    } sd_bench_t;
+
+    enum
+    {
+        SD_SEEK_CONTIG, // one f_expand'ed run of clusters
+        SD_SEEK_FRAG,   // split up by a filler file
+        SD_SEEK_FILES
+    };
+
+    typedef struct
+    {
+        uint32_t avg_us;
+        uint32_t max_us;
+    } sd_seek_time_t;
+
+    typedef struct
+    {
+        uint32_t fragments[SD_SEEK_FILES];
+        sd_seek_time_t walk[SD_SEEK_FILES]; // f_lseek following the FAT
+        sd_seek_time_t clmt[SD_SEEK_FILES]; // f_lseek with a link map
+    } sd_seek_bench_t;
+
     FRESULT build_tree(const char *path, DirEntry **out_node, bool recurse);
     void print_tree(DirEntry *node, int level);
     void free_tree(DirEntry *node);
     int prep_sd_card();
+    bool sd_card_mounted(void);
+    FRESULT sd_card_benchmark(sd_bench_t *out);
+    FRESULT sd_open_fast(FIL *fp, const char *path, BYTE mode);
+    FRESULT sd_close_fast(FIL *fp);
+    uint32_t sd_file_fragments(const FIL *fp);
+    FRESULT sd_seek_benchmark(sd_seek_bench_t *out);
     DirEntry *create_entry(const char *name, int is_dir);
 
 
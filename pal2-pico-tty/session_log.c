@@ -0,0 +1,359 @@
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "session_log.h"
+#include "session_log_format.h"
+#include "uart_bridge.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define LOG_TAP_SIZE (16 * 1024)      // 2048 events, power of two
+#define LOG_INDEX_MAX 1024            // thinned by half when full
+#define LOG_SYNC_US (10 * 1000 * 1000) // partial block to the card this often
+#define LOG_MAX_FILES 10000
+
+static uint8_t log_storage[LOG_TAP_SIZE];
+static bridge_tap_t log_tap;
+static FIL log_fp;
+static bool active;
+static uint64_t start_us;
+static uint64_t next_sync_us;
+static uint32_t last_baud;
+static session_log_report_t report;
+
+/* block being filled */
+static uint8_t block[SESSION_BLOCK_SIZE] __attribute__((aligned(4)));
+static session_block_header_t blk;
+static uint32_t blk_pos; // next payload byte in `block`
+static uint64_t blk_last_us; // start of the last run written
+
+/* run being gathered */
+static uint8_t run_buf[SESSION_MAX_RUN];
+static uint32_t run_len;
+static uint8_t run_dir;
+static uint64_t run_first_us;
+static uint64_t run_last_us;
+static uint64_t clock_us; // latest session time seen; keeps runs in order
+
+static uint32_t index_ms[LOG_INDEX_MAX];
+static uint32_t index_entries;
+static uint32_t index_stride;
+
+static FRESULT next_free_path(char *path)
+{
+    FILINFO fno;
+
+    for (unsigned n = 0; n < LOG_MAX_FILES; n++)
+    {
+        snprintf(path, SESSION_NAME_LEN, SESSION_PATH_FMT, n);
+        FRESULT fr = f_stat(path, &fno);
+        if (fr == FR_NO_FILE)
+            return FR_OK;
+        if (fr != FR_OK)
+            return fr;
+    }
+    return FR_DENIED;
+}
+
+static inline uint32_t put_varint(uint8_t *p, uint64_t v)
+{
+    uint32_t n = 0;
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static void fail(FRESULT fr)
+{
+    if (report.err == FR_OK)
+    {
+        report.err = fr;
+        debug_printf("session log: error %d\n", fr);
+    }
+}
+
+static void write_at(FSIZE_t ofs, const void *p, UINT n)
+{
+    UINT bw = 0;
+    FRESULT fr = f_lseek(&log_fp, ofs);
+    if (fr == FR_OK)
+        fr = f_write(&log_fp, p, n, &bw);
+    if (fr == FR_OK && bw < n)
+        fr = FR_DENIED; // disk full
+    if (fr != FR_OK)
+        fail(fr);
+}
+
+/* Keep at most LOG_INDEX_MAX entries by dropping every other one
+ * and doubling the blocks each covers.                             */
+static void index_add(uint32_t seq, uint64_t t0_us)
+{
+    if (seq % index_stride)
+        return;
+
+    if (index_entries == LOG_INDEX_MAX)
+    {
+        for (uint32_t i = 0; i < LOG_INDEX_MAX / 2; i++)
+            index_ms[i] = index_ms[2 * i];
+        index_entries = LOG_INDEX_MAX / 2;
+        index_stride *= 2;
+        if (seq % index_stride)
+            return;
+    }
+    index_ms[index_entries++] = (uint32_t)(t0_us / 1000);
+}
+
+/* Write the block into its slot.  A partial block (periodic sync)
+ * is rewritten in place once it fills up; `advance` moves on.      */
+static void flush_block(bool advance)
+{
+    if (blk.runs == 0 || report.err != FR_OK)
+        return;
+
+    blk.used = (uint16_t)(blk_pos - sizeof blk);
+    memcpy(block, &blk, sizeof blk);
+    memset(block + blk_pos, 0, SESSION_BLOCK_SIZE - blk_pos);
+    write_at(SESSION_HEADER_SIZE + (FSIZE_t)blk.seq * SESSION_BLOCK_SIZE, block, SESSION_BLOCK_SIZE);
+
+    if (!advance)
+        return;
+
+    index_add(blk.seq, blk.t0_us);
+    report.blocks = ++blk.seq;
+    blk.runs = 0;
+    blk.bytes = 0;
+    blk_pos = sizeof blk;
+}
+
+static void emit_run(uint8_t dir, const uint8_t *data, uint32_t len, uint64_t first_us, uint32_t span_us)
+{
+    uint8_t head[10 + 5 + 5];
+
+    if (report.err != FR_OK)
+        return; // the log is dead; flush_block() no longer empties `block`
+
+    if (blk_pos + sizeof head + len > SESSION_BLOCK_SIZE)
+    {
+        flush_block(true);
+        if (report.err != FR_OK)
+            return;
+    }
+
+    if (blk.runs == 0)
+    {
+        blk.t0_us = first_us;
+        blk_last_us = first_us;
+    }
+
+    uint32_t n = put_varint(head, ((first_us - blk_last_us) << 2) | dir);
+    n += put_varint(head + n, len);
+    n += put_varint(head + n, span_us);
+
+    memcpy(block + blk_pos, head, n);
+    memcpy(block + blk_pos + n, data, len);
+    blk_pos += n + len;
+    blk_last_us = first_us;
+    blk.runs++;
+    blk.bytes += len;
+
+    report.runs++;
+    if (dir != SESSION_DIR_BAUD)
+        report.bytes += len;
+}
+
+static void close_run(void)
+{
+    if (run_len)
+    {
+        emit_run(run_dir, run_buf, run_len, run_first_us, (uint32_t)(run_last_us - run_first_us));
+        run_len = 0;
+    }
+}
+
+static void add_byte(uint8_t dir, uint8_t c, uint64_t t_us)
+{
+    if (run_len && (dir != run_dir || run_len == SESSION_MAX_RUN ||
+                    t_us - run_last_us > SESSION_RUN_GAP_US))
+        close_run();
+
+    if (run_len == 0)
+    {
+        run_dir = dir;
+        run_first_us = t_us;
+    }
+    run_buf[run_len++] = c;
+    run_last_us = t_us;
+}
+
+static void note_baud(uint64_t t_us)
+{
+    uint32_t baud = uart_bridge_get_baud();
+    if (baud == last_baud)
+        return;
+
+    uint8_t le[4] = {baud, baud >> 8, baud >> 16, baud >> 24};
+    close_run();
+    emit_run(SESSION_DIR_BAUD, le, sizeof le, t_us, 0);
+    last_baud = baud;
+}
+
+/* ----------------------------------------------------------------
+ *  session_log_start()
+ *  – create the next free SESSION_PATH_FMT file, write its header
+ *    and start logging both directions through a stamped tap.
+ * ---------------------------------------------------------------- */
+FRESULT session_log_start(void)
+{
+    FRESULT fr;
+
+    if (active)
+        return FR_OK;
+
+    memset(&report, 0, sizeof report);
+    fr = next_free_path(report.path);
+    if (fr == FR_OK)
+        fr = f_open(&log_fp, report.path, FA_WRITE | FA_CREATE_NEW);
+    if (fr != FR_OK)
+    {
+        debug_printf("session log: cannot create %s: %d\n", report.path, fr);
+        return fr;
+    }
+
+    memset(&blk, 0, sizeof blk);
+    blk.magic = SESSION_BLOCK_MAGIC;
+    blk_pos = sizeof blk;
+    run_len = 0;
+    clock_us = 0;
+    index_entries = 0;
+    index_stride = 1;
+
+    start_us = time_us_64();
+    last_baud = uart_bridge_get_baud();
+
+    session_file_header_t fh = {
+        .magic = SESSION_FILE_MAGIC,
+        .version = SESSION_VERSION,
+        .header_size = SESSION_HEADER_SIZE,
+        .block_size = SESSION_BLOCK_SIZE,
+        .baud = last_baud,
+        .start_us = start_us,
+    };
+    memset(block, 0, SESSION_HEADER_SIZE);
+    memcpy(block, &fh, sizeof fh);
+    write_at(0, block, SESSION_HEADER_SIZE);
+
+    if (report.err == FR_OK && !uart_bridge_tap_attach_stamped(&log_tap, log_storage, sizeof log_storage))
+    {
+        debug_printf("session log: no free tap\n");
+        report.err = FR_TOO_MANY_OPEN_FILES;
+    }
+    if (report.err != FR_OK)
+    {
+        f_close(&log_fp);
+        f_unlink(report.path);
+        return report.err;
+    }
+
+    next_sync_us = start_us + LOG_SYNC_US;
+    active = true;
+    debug_printf("session log: %s\n", report.path);
+    return FR_OK;
+}
+
+bool session_log_active(void)
+{
+    return active;
+}
+
+const char *session_log_path(void)
+{
+    return report.path;
+}
+
+/* ----------------------------------------------------------------
+ *  session_log_poll()
+ *  – turn queued events into runs.  Tap stamps are 32‑bit, so they
+ *    are widened against the current time: fine as long as nothing
+ *    sits in the tap for an hour.  RX stamps come from the IRQ and
+ *    can overtake a TX stamp by a few us; the clamp keeps the log
+ *    monotonic.  Every LOG_SYNC_US the partial block goes to the
+ *    card so a power cut loses little.
+ * ---------------------------------------------------------------- */
+void session_log_poll(void)
+{
+    bridge_event_t ev;
+
+    if (!active || report.err != FR_OK)
+        return;
+
+    uint64_t now = time_us_64();
+
+    while (report.err == FR_OK && spsc_ring_read(&log_tap.ring, &ev, sizeof ev))
+    {
+        uint64_t t = now - (uint32_t)((uint32_t)now - ev.t_us) - start_us;
+        clock_us = MAX(clock_us, t);
+        add_byte(ev.dir, ev.c, clock_us);
+    }
+
+    clock_us = MAX(clock_us, now - start_us);
+    note_baud(clock_us);
+
+    if (now >= next_sync_us)
+    {
+        if (run_len && clock_us - run_last_us > SESSION_RUN_GAP_US)
+            close_run();
+        flush_block(false);
+        if (report.err == FR_OK)
+            fail(f_sync(&log_fp));
+        next_sync_us = now + LOG_SYNC_US;
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  session_log_stop()
+ *  – finish the last block, append the index and trailer.
+ * ---------------------------------------------------------------- */
+void session_log_stop(session_log_report_t *out)
+{
+    if (active)
+    {
+        session_log_poll();
+        uart_bridge_tap_detach(&log_tap);
+        session_log_poll();
+        active = false;
+
+        close_run();
+        flush_block(true);
+
+        session_trailer_t tr = {
+            .blocks = blk.seq,
+            .stride = index_stride,
+            .entries = index_entries,
+            .end_ms = (uint32_t)((time_us_64() - start_us) / 1000),
+            .magic = SESSION_INDEX_MAGIC,
+        };
+        FSIZE_t ofs = SESSION_HEADER_SIZE + (FSIZE_t)blk.seq * SESSION_BLOCK_SIZE;
+        write_at(ofs, index_ms, index_entries * sizeof index_ms[0]);
+        write_at(ofs + index_entries * sizeof index_ms[0], &tr, sizeof tr);
+
+        if (report.err == FR_OK)
+            fail(f_truncate(&log_fp));
+        fail(f_close(&log_fp));
+
+        report.dropped = log_tap.dropped;
+        report.elapsed_us = time_us_64() - start_us;
+        debug_printf("session log: %s %lu bytes, %lu runs, %lu blocks, %lu dropped\n",
+                     report.path, (unsigned long)report.bytes, (unsigned long)report.runs,
+                     (unsigned long)report.blocks, (unsigned long)report.dropped);
+    }
+
+    if (out)
+        *out = report;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "sd-card/sd-card.h"
+
+#define SESSION_PATH_FMT "0:/log%04u.psl"
+#define SESSION_NAME_LEN 20
+
+    typedef struct
+    {
+        char path[SESSION_NAME_LEN];
+        uint32_t bytes;   // data bytes logged, all directions
+        uint32_t runs;
+        uint32_t blocks;
+        uint32_t dropped; // events lost because the tap was full
+        FRESULT err;      // first error, FR_OK if none
+        uint64_t elapsed_us;
+    } session_log_report_t;
+
+    /* Timestamped log of both directions of the PAL link, in the
+     * format described in session_log_format.h.                     */
+    FRESULT session_log_start(void);
+    void session_log_stop(session_log_report_t *out);
+    bool session_log_active(void);
+    const char *session_log_path(void);
+    void session_log_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
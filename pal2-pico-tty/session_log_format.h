@@ -0,0 +1,87 @@
+#pragma once
+
+/* ----------------------------------------------------------------
+ *  PAL‑2 session log (.psl) on‑disk format, shared with tools/.
+ *  Little‑endian, as both the RP2040 and the hosts we care about are.
+ *
+ *  [file header, padded to SESSION_HEADER_SIZE]
+ *  [block 0][block 1] ... each SESSION_BLOCK_SIZE, zero padded
+ *  [index: uint32_t first_ms per index entry]
+ *  [trailer]
+ *
+ *  Every block starts with the absolute session time of its first
+ *  run, so decoding can begin at any block.  The index lets a reader
+ *  jump close to a point in time without touching the blocks; a log
+ *  cut short by a power loss has no index but still scans.
+ *
+ *  Block payload is a sequence of runs:
+ *      varint  (delta_us << 2) | dir   since the previous run's start
+ *      varint  len
+ *      varint  span_us                 first to last byte of the run
+ *      len bytes
+ *  Bytes join a run while they keep the direction and arrive within
+ *  SESSION_RUN_GAP_US of each other; replay spreads them over span_us.
+ *  dir SESSION_DIR_BAUD carries the new PAL link rate, len 4.
+ * ---------------------------------------------------------------- */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SESSION_FILE_MAGIC 0x314C5350u  // "PSL1"
+#define SESSION_BLOCK_MAGIC 0x424C5350u // "PSLB"
+#define SESSION_INDEX_MAGIC 0x584C5350u // "PSLX"
+#define SESSION_VERSION 1
+
+#define SESSION_HEADER_SIZE 512
+#define SESSION_BLOCK_SIZE 4096
+#define SESSION_RUN_GAP_US 2000
+#define SESSION_MAX_RUN 255
+
+    enum
+    {
+        SESSION_DIR_PAL,    // PAL->USB
+        SESSION_DIR_HOST,   // USB->PAL, typed or sent by the host
+        SESSION_DIR_UPLOAD, // sent from the SD card by the pico
+        SESSION_DIR_BAUD,
+    };
+
+    typedef struct
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t header_size; // blocks start here
+        uint32_t block_size;
+        uint32_t baud;        // PAL link rate when the log started
+        uint64_t start_us;    // time_us_64() at start; session time 0
+    } session_file_header_t;
+
+    typedef struct
+    {
+        uint32_t magic;
+        uint32_t seq;   // block number from 0
+        uint64_t t0_us; // session time of the first run
+        uint16_t used;  // payload bytes after this header
+        uint16_t runs;
+        uint32_t bytes; // data bytes in those runs
+    } session_block_header_t;
+
+    typedef struct
+    {
+        uint32_t blocks;
+        uint32_t stride;  // blocks per index entry
+        uint32_t entries; // uint32_t first_ms values just before this
+        uint32_t end_ms;  // session length
+        uint32_t magic;
+    } session_trailer_t;
+
+    _Static_assert(sizeof(session_file_header_t) == 24, "header layout");
+    _Static_assert(sizeof(session_block_header_t) == 24, "block layout");
+    _Static_assert(sizeof(session_trailer_t) == 20, "trailer layout");
+
+#ifdef __cplusplus
+}
+#endif
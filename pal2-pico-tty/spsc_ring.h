@@ -0,0 +1,120 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+    /* ----------------------------------------------------------------
+     *  Single‑producer / single‑consumer byte ring
+     *
+     *  One side only ever writes `head`, the other only ever writes
+     *  `tail`, so no lock is needed as long as each side stays on its
+     *  own context (IRQ vs. task).  Size must be a power of two.
+     * ---------------------------------------------------------------- */
+    typedef struct
+    {
+        uint8_t *data;
+        uint32_t mask;          // size - 1
+        volatile uint32_t head; // free‑running, written by producer only
+        volatile uint32_t tail; // free‑running, written by consumer only
+    } spsc_ring_t;
+
+    static inline void spsc_ring_init(spsc_ring_t *r, uint8_t *storage, uint32_t size)
+    {
+        r->data = storage;
+        r->mask = size - 1;
+        r->head = 0;
+        r->tail = 0;
+    }
+
+    static inline uint32_t spsc_ring_count(const spsc_ring_t *r)
+    {
+        return r->head - r->tail;
+    }
+
+    static inline uint32_t spsc_ring_space(const spsc_ring_t *r)
+    {
+        return (r->mask + 1) - (r->head - r->tail);
+    }
+
+    static inline bool spsc_ring_push(spsc_ring_t *r, uint8_t c)
+    {
+        uint32_t head = r->head;
+        if (head - r->tail > r->mask)
+            return false; // full
+
+        r->data[head & r->mask] = c;
+        __dmb(); // data must land before the new head is visible
+        r->head = head + 1;
+        return true;
+    }
+
+    static inline bool spsc_ring_pop(spsc_ring_t *r, uint8_t *c)
+    {
+        uint32_t tail = r->tail;
+        if (r->head == tail)
+            return false; // empty
+
+        __dmb();
+        *c = r->data[tail & r->mask];
+        __dmb(); // finish the read before handing the slot back
+        r->tail = tail + 1;
+        return true;
+    }
+
+    /* Longest run of readable bytes that does not wrap; pair with
+     * spsc_ring_consume() to hand whole chunks to a bulk writer.      */
+    static inline uint32_t spsc_ring_peek(const spsc_ring_t *r, const uint8_t **p)
+    {
+        uint32_t tail = r->tail;
+        uint32_t count = r->head - tail;
+        uint32_t idx = tail & r->mask;
+        uint32_t contig = (r->mask + 1) - idx;
+
+        __dmb();
+        *p = &r->data[idx];
+        return MIN(count, contig);
+    }
+
+    static inline void spsc_ring_consume(spsc_ring_t *r, uint32_t n)
+    {
+        __dmb();
+        r->tail += n;
+    }
+
+    /* Fixed‑size records: all n bytes go in (or come out) or none do,
+     * so the consumer never sees half a record.                      */
+    static inline bool spsc_ring_write(spsc_ring_t *r, const void *src, uint32_t n)
+    {
+        uint32_t head = r->head;
+        if (spsc_ring_space(r) < n)
+            return false;
+
+        for (uint32_t i = 0; i < n; i++)
+            r->data[(head + i) & r->mask] = ((const uint8_t *)src)[i];
+        __dmb();
+        r->head = head + n;
+        return true;
+    }
+
+    static inline bool spsc_ring_read(spsc_ring_t *r, void *dst, uint32_t n)
+    {
+        uint32_t tail = r->tail;
+        if (r->head - tail < n)
+            return false;
+
+        __dmb();
+        for (uint32_t i = 0; i < n; i++)
+            ((uint8_t *)dst)[i] = r->data[(tail + i) & r->mask];
+        __dmb();
+        r->tail = tail + n;
+        return true;
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,377 @@
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "tape_in.h"
+#include "tape_in.pio.h"
+#include "kim_tape.h"
+#include "kim_ptp.h"
+#include "spsc_ring.h"
+#include "uart_bridge.h"
+#include "proj_hw.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define TAPE_IN_RING_BITS 13     // 8 KB: 2048 half cycles, ~350 ms of tape
+#define TAPE_IN_BATCH 64         // half cycles decoded per pump pass
+#define TAPE_IN_EVENT_RING 1024  // bytes; 4 per event, ~30 s of data at tape speed
+#define TAPE_IN_COUNT_HZ 1000000 // tape_in.pio counts in microseconds
+
+#define RING_WORDS ((1u << TAPE_IN_RING_BITS) / sizeof(uint32_t))
+
+/* The DMA write ring wraps on an address boundary of its own size. */
+static uint32_t ring[RING_WORDS] __attribute__((aligned(1 << TAPE_IN_RING_BITS)));
+
+/* Decoder events, core 1 -> core 0, all fixed size */
+typedef struct
+{
+    int8_t ev; // KIM_TAPE_EV_* or KIM_TAPE_ERR_*
+    uint8_t a, b, c;
+} tape_event_t;
+
+static uint8_t event_storage[TAPE_IN_EVENT_RING];
+static spsc_ring_t events;
+
+/* Core 1 only while the job is attached */
+static kim_tape_decoder_t dec;
+static uint32_t rd; // half cycles taken out of `ring`, free running
+static volatile uint32_t halves, overruns, dropped;
+
+static int sm = -1;
+static int dma_ch = -1;
+static uint offset;
+static bool running;
+
+/* Core 0: the record being written */
+static FIL bin_fp, ptp_fp;
+static bool rec_open;
+static uint32_t open_dropped; // `dropped` when the record started
+static ptp_encoder_t ptp;
+static tape_in_report_t report;
+
+static void emit(int ev)
+{
+    tape_event_t e = {.ev = (int8_t)ev};
+
+    if (ev == KIM_TAPE_EV_HEADER)
+    {
+        e.a = dec.id;
+        e.b = dec.addr & 0xFF;
+        e.c = dec.addr >> 8;
+    }
+    else if (ev == KIM_TAPE_EV_DATA)
+    {
+        e.a = dec.data;
+    }
+    else
+    {
+        e.a = dec.sum & 0xFF;
+        e.b = dec.sum >> 8;
+    }
+
+    if (!spsc_ring_write(&events, &e, sizeof e))
+        dropped++;
+}
+
+/* ----------------------------------------------------------------
+ *  decode_job()
+ *  – core 1, between bridge passes: take what the DMA has written
+ *    since last time, at most TAPE_IN_BATCH so the link never waits
+ *    long.  `transfer_count` counts down from ~0, so its complement
+ *    is the number of words written.
+ * ---------------------------------------------------------------- */
+static bool decode_job(void *ctx)
+{
+    (void)ctx;
+
+    uint32_t written = ~dma_channel_hw_addr(dma_ch)->transfer_count;
+    uint32_t behind = written - rd;
+    if (behind == 0)
+        return false;
+
+    if (behind > RING_WORDS)
+    {
+        /* lapped: skip to half a ring back and let the decoder resync */
+        overruns += behind - RING_WORDS / 2;
+        rd = written - RING_WORDS / 2;
+        int ev = kim_tape_decode_half(&dec, UINT32_MAX);
+        if (ev)
+            emit(ev);
+        behind = RING_WORDS / 2;
+    }
+
+    uint32_t n = MIN(behind, TAPE_IN_BATCH);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        int ev = kim_tape_decode_half(&dec, ring[rd++ & (RING_WORDS - 1)]);
+        if (ev)
+            emit(ev);
+    }
+    halves += n;
+    return true;
+}
+
+static FRESULT open_record(FIL *fp, const char *ext)
+{
+    char path[TAPE_IN_NAME_LEN + 4];
+    snprintf(path, sizeof path, "%s%s", report.path, ext);
+    return f_open(fp, path, FA_WRITE | FA_CREATE_ALWAYS);
+}
+
+static void unlink_record(const char *ext)
+{
+    char path[TAPE_IN_NAME_LEN + 4];
+    snprintf(path, sizeof path, "%s%s", report.path, ext);
+    f_unlink(path);
+}
+
+static void start_record(const tape_event_t *e)
+{
+    report.id = e->a;
+    report.addr = e->b | e->c << 8;
+    report.bytes = 0;
+    report.in_record = true;
+    snprintf(report.path, sizeof report.path, TAPE_IN_PATH_FMT, report.id, report.addr);
+
+    FRESULT fr = open_record(&bin_fp, ".bin");
+    if (fr == FR_OK)
+    {
+        fr = open_record(&ptp_fp, ".ptp");
+        if (fr != FR_OK)
+            f_close(&bin_fp);
+    }
+    if (fr != FR_OK)
+    {
+        report.fr = fr;
+        report.in_record = false; // its events are ignored, count it now
+        report.bad++;
+        report.last_err = TAPE_IN_ERR_CARD;
+        return;
+    }
+
+    ptp_encoder_init(&ptp, report.addr, PTP_DUMP_BYTES);
+    rec_open = true;
+    open_dropped = dropped;
+    debug_printf("tape_in: %s started\n", report.path);
+}
+
+static void discard_record(int err)
+{
+    f_close(&bin_fp);
+    f_close(&ptp_fp);
+    unlink_record(".bin");
+    unlink_record(".ptp");
+    rec_open = false;
+    report.in_record = false;
+    report.bad++;
+    report.last_err = err;
+    debug_printf("tape_in: %s discarded: %s\n", report.path, tape_in_strerror(err));
+}
+
+static bool write_all(FIL *fp, const void *p, UINT n)
+{
+    UINT bw;
+    FRESULT fr = f_write(fp, p, n, &bw);
+    if (fr == FR_OK && bw != n)
+        fr = FR_DENIED; // card full
+    if (fr != FR_OK)
+        report.fr = fr;
+    return fr == FR_OK;
+}
+
+static void record_byte(uint8_t b)
+{
+    char line[2 * PTP_LINE_MAX];
+    size_t n = ptp_encode_byte(&ptp, b, line);
+
+    if (write_all(&bin_fp, &b, 1) && write_all(&ptp_fp, line, n))
+        report.bytes++;
+    else
+        discard_record(TAPE_IN_ERR_CARD);
+}
+
+static void finish_record(void)
+{
+    char line[2 * PTP_LINE_MAX];
+    size_t n = ptp_encode_end(&ptp, line);
+
+    /* a DATA event lost on the way means a hole in the file */
+    if (dropped != open_dropped)
+    {
+        discard_record(TAPE_IN_ERR_DROPPED);
+        return;
+    }
+    if (!write_all(&ptp_fp, line, n))
+    {
+        discard_record(TAPE_IN_ERR_CARD);
+        return;
+    }
+
+    FRESULT fr = f_close(&bin_fp);
+    FRESULT fr2 = f_close(&ptp_fp);
+    rec_open = false;
+    report.in_record = false;
+    if (fr == FR_OK)
+        fr = fr2;
+    if (fr != FR_OK)
+    {
+        report.fr = fr;
+        report.bad++;
+        report.last_err = TAPE_IN_ERR_CARD;
+        return;
+    }
+    report.records++;
+    debug_printf("tape_in: %s.bin $%04X+%lu saved\n", report.path, report.addr,
+                 (unsigned long)report.bytes);
+}
+
+static void take_event(const tape_event_t *e)
+{
+    switch (e->ev)
+    {
+    case KIM_TAPE_EV_HEADER:
+        if (rec_open)
+            discard_record(KIM_TAPE_ERR_SIGNAL);
+        start_record(e);
+        break;
+
+    case KIM_TAPE_EV_DATA:
+        if (rec_open)
+            record_byte(e->a);
+        break;
+
+    case KIM_TAPE_EV_END:
+        if (rec_open)
+            finish_record();
+        report.in_record = false;
+        break;
+
+    default:
+        if (rec_open)
+            discard_record(e->ev);
+        else if (report.in_record) // never opened: count it all the same
+        {
+            report.in_record = false;
+            report.bad++;
+            report.last_err = e->ev;
+        }
+        break;
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  tape_in_begin() / tape_in_poll() / tape_in_end()
+ *  – capture whatever the PAL saves to tape until end().  poll()
+ *    writes out what core 1 has decoded; call it often enough to
+ *    drain TAPE_IN_EVENT_RING.  begin() is false if pio1, a DMA
+ *    channel or the bridge job slot is taken.
+ * ---------------------------------------------------------------- */
+bool tape_in_begin(void)
+{
+    PIO pio = TAPE_IN_PIO;
+
+    memset(&report, 0, sizeof report);
+    rec_open = false;
+
+    sm = pio_claim_unused_sm(pio, false);
+    dma_ch = dma_claim_unused_channel(false);
+    if (sm < 0 || dma_ch < 0 || !pio_can_add_program(pio, &tape_in_program))
+    {
+        debug_printf("tape_in: no room on pio1 or no DMA channel\n");
+        tape_in_end(NULL);
+        return false;
+    }
+
+    spsc_ring_init(&events, event_storage, sizeof event_storage);
+    kim_tape_decoder_init(&dec);
+    rd = 0;
+    halves = overruns = dropped = 0;
+
+    offset = pio_add_program(pio, &tape_in_program);
+    float div = (float)clock_get_hz(clk_sys) / (3 * TAPE_IN_COUNT_HZ);
+    tape_in_program_init(pio, sm, offset, TAPE_IN_GPIO, div);
+    gpio_pull_down(TAPE_IN_GPIO); // nothing plugged in: quiet, not noise
+
+    dma_channel_config c = dma_channel_get_default_config(dma_ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, TAPE_IN_RING_BITS);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+    dma_channel_configure(dma_ch, &c, ring, &pio->rxf[sm], UINT32_MAX, true);
+
+    if (!uart_bridge_job_attach(decode_job, NULL))
+    {
+        debug_printf("tape_in: bridge job slot taken\n");
+        dma_channel_abort(dma_ch);
+        pio_remove_program(pio, &tape_in_program, offset);
+        tape_in_end(NULL);
+        return false;
+    }
+    running = true;
+    pio_sm_set_enabled(pio, sm, true);
+    return true;
+}
+
+void tape_in_poll(tape_in_report_t *out)
+{
+    tape_event_t e;
+
+    while (spsc_ring_read(&events, &e, sizeof e))
+        take_event(&e);
+
+    report.halves = halves;
+    report.overruns = overruns;
+    report.dropped = dropped;
+    if (out)
+        *out = report;
+}
+
+void tape_in_end(tape_in_report_t *out)
+{
+    PIO pio = TAPE_IN_PIO;
+
+    if (running)
+    {
+        uart_bridge_job_detach();
+        pio_sm_set_enabled(pio, sm, false);
+        dma_channel_abort(dma_ch);
+        pio_remove_program(pio, &tape_in_program, offset);
+        running = false;
+
+        tape_in_poll(NULL); // what core 1 got to before it stopped
+        if (rec_open)
+            discard_record(KIM_TAPE_ERR_SIGNAL); // cut off part way
+    }
+
+    if (sm >= 0)
+        pio_sm_unclaim(pio, sm);
+    if (dma_ch >= 0)
+        dma_channel_unclaim(dma_ch);
+    sm = dma_ch = -1;
+
+    debug_printf("tape_in: %lu saved, %lu bad, %lu halves, %lu overrun, %lu dropped\n",
+                 (unsigned long)report.records, (unsigned long)report.bad,
+                 (unsigned long)report.halves, (unsigned long)report.overruns,
+                 (unsigned long)report.dropped);
+    if (out)
+        *out = report;
+}
+
+const char *tape_in_strerror(int err)
+{
+    switch (err)
+    {
+    case TAPE_IN_ERR_CARD:
+        return "card write";
+    case TAPE_IN_ERR_DROPPED:
+        return "fell behind";
+    default:
+        return kim_tape_strerror(err);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "sd-card/sd-card.h"
+
+#define TAPE_IN_PIO pio1 // pio0's instruction memory is wiped by the switch mirror
+#define TAPE_IN_PATH_FMT "0:/tape%02X@%04X" // ID, SA; the '@' gives a .bin its load address
+#define TAPE_IN_NAME_LEN 24
+
+    /* ----------------------------------------------------------------
+     *  KIM‑1 cassette capture
+     *
+     *  tape_in.pio times every half cycle on TAPE_IN_GPIO into a DMA
+     *  ring; a bridge job on core 1 runs them through the kim_tape
+     *  decoder as they land, and core 0 writes each record that
+     *  passes its checksum as both <path>.bin and <path>.ptp.
+     *  Records that fail are deleted again and counted.
+     * ---------------------------------------------------------------- */
+
+    enum
+    {
+        TAPE_IN_ERR_CARD = -10,    // the record could not be written, see fr
+        TAPE_IN_ERR_DROPPED = -11, // core 0 fell behind and lost part of it
+    };
+
+    typedef struct
+    {
+        char path[TAPE_IN_NAME_LEN]; // last record started, without extension
+        bool in_record;
+        uint8_t id;
+        uint16_t addr;
+        uint32_t bytes;         // of the record in progress, or the last one
+        uint32_t records;       // saved
+        uint32_t bad;           // failed and deleted
+        int last_err;           // KIM_TAPE_ERR_* / TAPE_IN_ERR_* of the last bad one
+        uint32_t halves;        // half cycles timed
+        uint32_t overruns;      // half cycles the decoder fell behind on
+        uint32_t dropped;       // events core 0 didn't collect in time
+        FRESULT fr;
+    } tape_in_report_t;
+
+    bool tape_in_begin(void);
+    void tape_in_poll(tape_in_report_t *out);
+    void tape_in_end(tape_in_report_t *out);
+    const char *tape_in_strerror(int err);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,331 @@
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "tape_out.h"
+#include "tape_out.pio.h"
+#include "ptp_io.h"
+#include "proj_hw.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define TAPE_OUT_READ 64         // image bytes read per refill of the stage
+#define TAPE_OUT_PROGRESS_MS 100 // between progress callbacks
+#define TAPE_OUT_DRAIN_MS 70     // longest character (8 x 1325 units) plus margin
+
+/* ----------------------------------------------------------------
+ *  Tape characters come from a small stage: the header, then the
+ *  image TAPE_OUT_READ bytes at a time, then the trailer.
+ * ---------------------------------------------------------------- */
+enum
+{
+    PH_DATA,
+    PH_DONE,
+};
+
+typedef struct
+{
+    FIL *fp;
+    kim_tape_encoder_t enc;
+    uint32_t left;     // image bytes still to read
+    int phase;
+    uint8_t stage[MAX(KIM_TAPE_HEAD_MAX, 2 * TAPE_OUT_READ)];
+    size_t stage_len;
+    size_t stage_pos;
+    tape_out_report_t *r;
+} producer_t;
+
+static uint8_t dma_buf[2][TAPE_OUT_CHUNK];
+
+static void fail(tape_out_report_t *r, int err)
+{
+    if (!r->err)
+        r->err = err;
+}
+
+static bool producer_done(const producer_t *p)
+{
+    return p->phase == PH_DONE && p->stage_pos == p->stage_len;
+}
+
+static void restage(producer_t *p)
+{
+    p->stage_pos = 0;
+    p->stage_len = 0;
+
+    if (p->phase != PH_DATA)
+        return;
+
+    if (p->left == 0 || p->r->err)
+    {
+        /* on a read error the tape still ends properly; LOAD sees the bad checksum */
+        p->stage_len = kim_tape_encode_end(&p->enc, p->stage);
+        p->phase = PH_DONE;
+        return;
+    }
+
+    uint8_t block[TAPE_OUT_READ];
+    UINT got = 0;
+    p->r->fr = f_read(p->fp, block, MIN(p->left, sizeof block), &got);
+    if (p->r->fr != FR_OK || got == 0)
+    {
+        fail(p->r, TAPE_OUT_ERR_FILE);
+        p->left = 0;
+        restage(p);
+        return;
+    }
+    p->left -= got;
+
+    for (UINT i = 0; i < got; i++)
+        p->stage_len += kim_tape_encode_byte(&p->enc, block[i], p->stage + p->stage_len);
+}
+
+static uint32_t fill(producer_t *p, uint8_t *buf)
+{
+    uint32_t n = 0;
+
+    while (n < TAPE_OUT_CHUNK)
+    {
+        if (p->stage_pos == p->stage_len)
+        {
+            if (p->phase == PH_DONE)
+                break;
+            restage(p);
+            continue;
+        }
+        size_t k = MIN(p->stage_len - p->stage_pos, TAPE_OUT_CHUNK - n);
+        memcpy(buf + n, p->stage + p->stage_pos, k);
+        p->stage_pos += k;
+        n += k;
+    }
+    return n;
+}
+
+/* ----------------------------------------------------------------
+ *  arm()
+ *  – load channel i with n characters from its buffer.  Unless this
+ *    is the last buffer it chains to the other channel, so the two
+ *    play back to back with no CPU in between; a channel chained to
+ *    itself is the SDK's "no chain".
+ * ---------------------------------------------------------------- */
+static void arm(PIO pio, uint sm, const int ch[2], int i, uint32_t n, bool last)
+{
+    dma_channel_config c = dma_channel_get_default_config(ch[i]);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    channel_config_set_chain_to(&c, last ? ch[i] : ch[i ^ 1]);
+    dma_channel_configure(ch[i], &c, &pio->txf[sm], dma_buf[i], n, false);
+}
+
+static void play(PIO pio, uint sm, const int ch[2], producer_t *p, tape_out_report_t *r,
+                 tape_out_progress_t progress, void *ctx)
+{
+    uint32_t len[2] = {0, 0};
+    bool last[2] = {false, false};
+    uint32_t sent = 0; // characters in buffers already played out
+    int cur = 0;
+
+    len[0] = fill(p, dma_buf[0]);
+    last[0] = producer_done(p);
+    arm(pio, sm, ch, 0, len[0], last[0]);
+    if (!last[0])
+    {
+        len[1] = fill(p, dma_buf[1]);
+        last[1] = producer_done(p);
+        arm(pio, sm, ch, 1, len[1], last[1]);
+    }
+
+    uint64_t t0 = time_us_64();
+    absolute_time_t next_report = make_timeout_time_ms(TAPE_OUT_PROGRESS_MS);
+    pio_sm_set_enabled(pio, sm, true);
+    dma_channel_start(ch[0]);
+
+    while (true)
+    {
+        if (dma_channel_is_busy(ch[cur]))
+        {
+            if (time_reached(next_report))
+            {
+                next_report = make_timeout_time_ms(TAPE_OUT_PROGRESS_MS);
+                uint32_t in_flight = len[cur] - dma_channel_hw_addr(ch[cur])->transfer_count;
+                if (progress && !progress(ctx, sent + in_flight, r->total))
+                {
+                    fail(r, TAPE_OUT_ERR_CANCEL);
+                    r->chars = sent + in_flight;
+                    break;
+                }
+            }
+            tight_loop_contents();
+            continue;
+        }
+
+        /* cur has played out; the other one is already running on the chain */
+        sent += len[cur];
+        if (last[cur])
+        {
+            r->chars = sent;
+            break;
+        }
+        len[cur] = fill(p, dma_buf[cur]);
+        if (len[cur])
+        {
+            last[cur] = producer_done(p);
+            arm(pio, sm, ch, cur, len[cur], last[cur]);
+        }
+        cur ^= 1;
+    }
+
+    if (r->err == TAPE_OUT_ERR_CANCEL)
+    {
+        dma_channel_abort(ch[0]);
+        dma_channel_abort(ch[1]);
+    }
+    else
+    {
+        /* the last characters are still in the FIFO and the OSR */
+        while (!pio_sm_is_tx_fifo_empty(pio, sm))
+            tight_loop_contents();
+        sleep_ms(TAPE_OUT_DRAIN_MS);
+    }
+    r->elapsed_us = time_us_64() - t0;
+
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_set_pins_with_mask(pio, sm, 0, 1u << TAPE_OUT_GPIO);
+}
+
+bool tape_out_supported(const char *file_name)
+{
+    return ptp_source_mode(file_name) == PTP_SRC_BIN;
+}
+
+/* ----------------------------------------------------------------
+ *  tape_out_run()
+ *  – play a .bin/.prg as a KIM‑1 tape with ID `id`.  Blocks until
+ *    the last EOT has left the pin or progress() says stop.
+ * ---------------------------------------------------------------- */
+void tape_out_run(const char *path, const char *file_name, uint8_t id,
+                  tape_out_report_t *r, tape_out_progress_t progress, void *ctx)
+{
+    FIL fp;
+    producer_t p;
+
+    memset(r, 0, sizeof *r);
+    r->id = id;
+
+    if (!tape_out_supported(file_name))
+    {
+        fail(r, TAPE_OUT_ERR_FORMAT);
+        return;
+    }
+
+    r->fr = sd_open_fast(&fp, path, FA_READ);
+    if (r->fr != FR_OK)
+    {
+        fail(r, TAPE_OUT_ERR_FILE);
+        return;
+    }
+
+    r->load = ptp_bin_load_addr(file_name);
+    r->bytes = f_size(&fp);
+
+    const char *dot = strrchr(file_name, '.');
+    if (dot && !strcasecmp(dot, ".prg"))
+    {
+        uint8_t hdr[2];
+        UINT got;
+        r->fr = f_read(&fp, hdr, sizeof hdr, &got);
+        if (r->fr != FR_OK)
+            fail(r, TAPE_OUT_ERR_FILE);
+        else if (got != sizeof hdr)
+            fail(r, TAPE_OUT_ERR_FORMAT);
+        else
+        {
+            r->load = hdr[0] | hdr[1] << 8;
+            r->bytes -= sizeof hdr;
+        }
+    }
+
+    if (!r->err && r->bytes == 0)
+        fail(r, TAPE_OUT_ERR_FORMAT);
+    if (!r->err && r->load + r->bytes > 0x10000)
+        fail(r, TAPE_OUT_ERR_RANGE);
+    if (r->err)
+    {
+        sd_close_fast(&fp);
+        return;
+    }
+
+    PIO pio = TAPE_OUT_PIO;
+    int sm = pio_claim_unused_sm(pio, false);
+    int ch[2] = {dma_claim_unused_channel(false), dma_claim_unused_channel(false)};
+    bool room = sm >= 0 && ch[0] >= 0 && ch[1] >= 0 && pio_can_add_program(pio, &tape_out_program);
+
+    if (!room)
+    {
+        fail(r, TAPE_OUT_ERR_PIO);
+        debug_printf("tape_out: no room on pio1 or no DMA channel\n");
+    }
+    else
+    {
+        uint offset = pio_add_program(pio, &tape_out_program);
+        float div = (float)clock_get_hz(clk_sys) / KIM_TAPE_UNIT_HZ;
+        tape_out_program_init(pio, sm, offset, TAPE_OUT_GPIO, div);
+
+        memset(&p, 0, sizeof p);
+        p.fp = &fp;
+        p.r = r;
+        p.left = r->bytes;
+        p.phase = PH_DATA;
+        kim_tape_encoder_init(&p.enc, id, r->load);
+        p.stage_len = kim_tape_encode_begin(&p.enc, p.stage);
+        r->total = p.stage_len + 2 * r->bytes + KIM_TAPE_TAIL_MAX;
+
+        debug_printf("tape_out: %s ID %02X $%04X+%lu, %lu chars, div %.3f\n", file_name, id,
+                     r->load, (unsigned long)r->bytes, (unsigned long)r->total, div);
+
+        play(pio, sm, ch, &p, r, progress, ctx);
+        r->checksum = p.enc.sum;
+
+        pio_remove_program(pio, &tape_out_program, offset);
+    }
+
+    if (sm >= 0)
+        pio_sm_unclaim(pio, sm);
+    for (int i = 0; i < 2; i++)
+    {
+        if (ch[i] >= 0)
+            dma_channel_unclaim(ch[i]);
+    }
+    sd_close_fast(&fp);
+
+    debug_printf("tape_out: %lu/%lu chars in %lu ms, err %d\n", (unsigned long)r->chars,
+                 (unsigned long)r->total, (unsigned long)(r->elapsed_us / 1000), r->err);
+}
+
+const char *tape_out_strerror(int err)
+{
+    switch (err)
+    {
+    case TAPE_OUT_OK:
+        return "ok";
+    case TAPE_OUT_ERR_FILE:
+        return "file error";
+    case TAPE_OUT_ERR_FORMAT:
+        return "not .bin/.prg";
+    case TAPE_OUT_ERR_RANGE:
+        return "bad load range";
+    case TAPE_OUT_ERR_PIO:
+        return "no PIO/DMA";
+    case TAPE_OUT_ERR_CANCEL:
+        return "cancelled";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "sd-card/sd-card.h"
+#include "kim_tape.h"
+
+#define TAPE_OUT_PIO pio1 // pio0's instruction memory is wiped by the switch mirror
+#define TAPE_OUT_CHUNK 256 // tape characters per DMA buffer (two of them)
+
+    /* ----------------------------------------------------------------
+     *  KIM‑1 cassette output
+     *
+     *  A .bin/.prg goes out on TAPE_OUT_GPIO as the monitor's audio
+     *  tape format (kim_tape.h), for its LOAD from tape at $1873.
+     *  tape_out.pio makes every cycle of both tones; two DMA channels
+     *  take turns feeding it tape characters, so the CPU only refills
+     *  a buffer every TAPE_OUT_CHUNK characters (about 15 s of tape).
+     * ---------------------------------------------------------------- */
+
+    enum
+    {
+        TAPE_OUT_OK = 0,
+        TAPE_OUT_ERR_FILE,   // open/read failed, see fr
+        TAPE_OUT_ERR_FORMAT, // not a .bin/.prg, or empty
+        TAPE_OUT_ERR_RANGE,  // image runs past $FFFF
+        TAPE_OUT_ERR_PIO,    // no room on TAPE_OUT_PIO, or no DMA channel
+        TAPE_OUT_ERR_CANCEL, // MENU pressed
+    };
+
+    typedef struct
+    {
+        uint8_t id;          // tape ID, for the monitor's $17F9
+        uint16_t load;
+        uint32_t bytes;      // image size
+        uint16_t checksum;   // CHKL/CHKH as written
+        uint32_t chars;      // tape characters played, leader to EOT
+        uint32_t total;      // ... of this many
+        uint64_t elapsed_us;
+        int err;             // TAPE_OUT_ERR_*
+        FRESULT fr;
+    } tape_out_report_t;
+
+    /* Called while the tape plays; return false to stop it. */
+    typedef bool (*tape_out_progress_t)(void *ctx, uint32_t done, uint32_t total);
+
+    bool tape_out_supported(const char *file_name);
+    void tape_out_run(const char *path, const char *file_name, uint8_t id,
+                      tape_out_report_t *r, tape_out_progress_t progress, void *ctx);
+    const char *tape_out_strerror(int err);
+
+#ifdef __cplusplus
+}
+#endif
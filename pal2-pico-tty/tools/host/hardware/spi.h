@@ -0,0 +1,5 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef struct spi_inst spi_inst_t;
@@ -0,0 +1,19 @@
+/* Just enough of the Pico SDK for the firmware's SD-side code to
+ * build on the host; FatFs itself is replaced by the test.         */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define KHZ 1000
+#define MHZ 1000000
+
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
@@ -0,0 +1,478 @@
+/*
+ * kimtape - KIM-1 audio cassettes on the host, using the firmware's
+ * own kim_tape.c.
+ *
+ *   kimtape wav [-i ID] [-a ADDR] [-r RATE] IMAGE OUT.wav
+ *                    .bin (at ADDR, default 0200) or .prg as the
+ *                    monitor's tape format, 16-bit mono PCM at RATE
+ *                    (default 44100) with the exact half-cycle
+ *                    timing tape_out.pio plays on the pin
+ *   kimtape decode [-i ID] IN.wav [OUT]
+ *                    list the records on a capture (8/16-bit PCM,
+ *                    first channel) and write the first good one, or
+ *                    the first with ID, as OUT: .prg, .bin or .ptp
+ *   kimtape test [DIR]
+ *                    wav -> decode round trips, with noise, at
+ *                    several sample rates, then the recordings in
+ *                    DIR (default fixtures/)
+ *
+ * fixtures/hello.wav is hello.bin at $0200, ID 01, as a cassette deck
+ * plays it back: 22050 Hz 8-bit PCM with a LIST chunk before the data,
+ * tones at the KIM-1's own 3623/2415 Hz run 2.5% fast with wow and
+ * flutter, rolled off near 5 kHz, AC coupled, inverted, with hiss and
+ * 50 Hz hum, and only 14 SYNs of leader left.  None of it comes from
+ * write_wav() or kim_tape.c.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "../kim_tape.h"
+#include "../kim_ptp.h"
+
+#define SILENCE_MS 500 /* before the leader and after the last EOT */
+#define LEVEL 16000
+#define HYSTERESIS 0.05 /* of full scale, around the running DC level */
+
+static FILE *open_or_die(const char *path, const char *mode)
+{
+    FILE *f = fopen(path, mode);
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    return f;
+}
+
+static int is_prg(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    return dot && strcasecmp(dot, ".prg") == 0;
+}
+
+static void put_le(FILE *f, unsigned long v, int bytes)
+{
+    while (bytes--) {
+        putc(v & 0xFF, f);
+        v >>= 8;
+    }
+}
+
+static unsigned long get_le(FILE *f, int bytes)
+{
+    unsigned long v = 0;
+    for (int i = 0; i < bytes; i++)
+        v |= (unsigned long)(getc(f) & 0xFF) << (8 * i);
+    return v;
+}
+
+/* Square wave renderer: time runs in 1/KIM_TAPE_UNIT_HZ units and
+ * each sample takes the level at its start, so rounding never builds
+ * up over a long tape. */
+typedef struct {
+    FILE *f;
+    unsigned long rate;
+    unsigned long long units; /* elapsed */
+    unsigned long long samples; /* written */
+    int noise; /* peak, for kimtape test */
+} wav_t;
+
+static void wav_level(wav_t *w, unsigned long units, int high)
+{
+    w->units += units;
+    unsigned long long end = w->units * w->rate / KIM_TAPE_UNIT_HZ;
+    for (; w->samples < end; w->samples++) {
+        int v = high ? LEVEL : -LEVEL;
+        if (w->noise)
+            v += rand() % (2 * w->noise + 1) - w->noise;
+        put_le(w->f, (unsigned)v & 0xFFFF, 2);
+    }
+}
+
+static void wav_char(wav_t *w, uint8_t c)
+{
+    uint16_t halves[KIM_TAPE_BIT_HALVES_MAX];
+
+    for (int bit = 0; bit < 8; bit++) {
+        size_t n = kim_tape_bit_halves((c >> bit) & 1, halves);
+        for (size_t i = 0; i < n; i++)
+            wav_level(w, halves[i], !(i & 1));
+    }
+}
+
+static void wav_chars(wav_t *w, const uint8_t *p, size_t n)
+{
+    while (n--)
+        wav_char(w, *p++);
+}
+
+/* The whole tape, leader to EOT, with silence either side. */
+static kim_tape_encoder_t write_wav(FILE *fo, FILE *fi, int id, long addr,
+                                    unsigned long rate, int noise, unsigned long long *samples)
+{
+    uint8_t buf[KIM_TAPE_HEAD_MAX];
+    kim_tape_encoder_t e;
+    wav_t w = { fo, rate, 0, 0, noise };
+    int c;
+
+    fwrite("RIFF\0\0\0\0WAVEfmt ", 1, 16, fo);
+    put_le(fo, 16, 4);
+    put_le(fo, 1, 2); /* PCM */
+    put_le(fo, 1, 2); /* mono */
+    put_le(fo, rate, 4);
+    put_le(fo, rate * 2, 4);
+    put_le(fo, 2, 2);
+    put_le(fo, 16, 2);
+    fwrite("data\0\0\0\0", 1, 8, fo);
+
+    /* the pin idles low between tapes */
+    wav_level(&w, (unsigned long)KIM_TAPE_UNIT_HZ * SILENCE_MS / 1000, 0);
+
+    kim_tape_encoder_init(&e, (uint8_t)id, (uint16_t)addr);
+    wav_chars(&w, buf, kim_tape_encode_begin(&e, buf));
+    while ((c = getc(fi)) != EOF)
+        wav_chars(&w, buf, kim_tape_encode_byte(&e, (uint8_t)c, buf));
+    wav_chars(&w, buf, kim_tape_encode_end(&e, buf));
+
+    wav_level(&w, (unsigned long)KIM_TAPE_UNIT_HZ * SILENCE_MS / 1000, 0);
+
+    unsigned long data = (unsigned long)w.samples * 2;
+    fseek(fo, 4, SEEK_SET);
+    put_le(fo, 36 + data, 4);
+    fseek(fo, 40, SEEK_SET);
+    put_le(fo, data, 4);
+    fseek(fo, 0, SEEK_END);
+
+    *samples = w.samples;
+    return e;
+}
+
+static int cmd_wav(const char *in, const char *out, int id, long addr, unsigned long rate)
+{
+    FILE *fi = open_or_die(in, "rb");
+    FILE *fo = open_or_die(out, "wb");
+    unsigned long long samples;
+
+    if (is_prg(in)) {
+        int lo = getc(fi), hi = getc(fi);
+        if (hi == EOF) {
+            fprintf(stderr, "%s: short .prg header\n", in);
+            return 1;
+        }
+        addr = lo | hi << 8;
+    }
+
+    kim_tape_encoder_t e = write_wav(fo, fi, id, addr, rate, 0, &samples);
+
+    fprintf(stderr, "%s: ID %02X $%04lX+%lu, CHK %04X, %.1f s\n", out, id,
+            (unsigned long)addr, (unsigned long)e.bytes, e.sum, (double)samples / rate);
+    fclose(fi);
+    fclose(fo);
+    return 0;
+}
+
+typedef struct {
+    unsigned long rate;
+    int channels, bits;
+    unsigned long frames;
+} wav_info_t;
+
+/* Leaves f at the first sample. */
+static int read_wav_header(FILE *f, const char *path, wav_info_t *wi)
+{
+    char id[4];
+
+    memset(wi, 0, sizeof *wi);
+    if (fread(id, 1, 4, f) != 4 || memcmp(id, "RIFF", 4))
+        goto bad;
+    get_le(f, 4);
+    if (fread(id, 1, 4, f) != 4 || memcmp(id, "WAVE", 4))
+        goto bad;
+
+    while (fread(id, 1, 4, f) == 4) {
+        unsigned long len = get_le(f, 4);
+        if (!memcmp(id, "fmt ", 4)) {
+            if (get_le(f, 2) != 1)
+                goto bad;
+            wi->channels = (int)get_le(f, 2);
+            wi->rate = get_le(f, 4);
+            get_le(f, 6);
+            wi->bits = (int)get_le(f, 2);
+            fseek(f, (long)(len - 16 + (len & 1)), SEEK_CUR);
+        } else if (!memcmp(id, "data", 4)) {
+            if (!wi->rate || (wi->bits != 8 && wi->bits != 16) || wi->channels < 1)
+                break;
+            wi->frames = len / (wi->channels * wi->bits / 8);
+            return 0;
+        } else {
+            fseek(f, (long)(len + (len & 1)), SEEK_CUR);
+        }
+    }
+bad:
+    fprintf(stderr, "%s: not an 8/16-bit PCM .wav\n", path);
+    return -1;
+}
+
+static double get_sample(FILE *f, const wav_info_t *wi)
+{
+    double v;
+
+    if (wi->bits == 8)
+        v = (getc(f) - 128) / 128.0;
+    else
+        v = (short)get_le(f, 2) / 32768.0;
+    for (int ch = 1; ch < wi->channels; ch++)
+        get_le(f, wi->bits / 8);
+    return v;
+}
+
+typedef struct {
+    uint8_t id;
+    uint16_t addr;
+    uint32_t bytes;
+    uint16_t sum;
+    int err;
+} record_t;
+
+/*
+ * Edges are where the signal crosses its running DC level, placed
+ * between samples by interpolation and confirmed by HYSTERESIS so
+ * hiss near zero doesn't double them.  Each half cycle then goes to
+ * the firmware's decoder in microseconds, as tape_in.pio feeds it.
+ * `image` gets the data of the first good record (with `want_id`,
+ * 0 for any) and *found its header; returns the record count.
+ */
+static int decode_wav(FILE *f, const char *path, int want_id, uint8_t *image,
+                      record_t *found, int verbose)
+{
+    static uint8_t cur[0x10000];
+    wav_info_t wi;
+    kim_tape_decoder_t d;
+    record_t rec = { 0 };
+    int records = 0, have = 0, high = 0, started = 0;
+    double dc = 0, prev = 0, zero_t = 0, edge_t = 0;
+
+    if (read_wav_header(f, path, &wi))
+        return -1;
+    kim_tape_decoder_init(&d);
+    memset(found, 0, sizeof *found);
+    found->err = KIM_TAPE_ERR_SIGNAL;
+
+    double k = 1.0 / (wi.rate * 0.02); /* 20 ms DC tracking */
+    for (unsigned long i = 0; i < wi.frames; i++) {
+        double s = get_sample(f, &wi);
+        dc += (s - dc) * k;
+        double v = s - dc;
+
+        if (i && (v < 0) != (prev < 0))
+            zero_t = (i - 1) + prev / (prev - v);
+        prev = v;
+
+        if (high ? v > -HYSTERESIS : v < HYSTERESIS)
+            continue;
+        high = !high;
+        if (!started) {
+            started = 1;
+            edge_t = zero_t;
+            continue;
+        }
+
+        double us = (zero_t - edge_t) * 1e6 / wi.rate;
+        edge_t = zero_t;
+
+        int ev = kim_tape_decode_half(&d, (uint32_t)(us + 0.5));
+        switch (ev) {
+        case KIM_TAPE_EV_NONE:
+            break;
+        case KIM_TAPE_EV_HEADER:
+            memset(&rec, 0, sizeof rec);
+            rec.id = d.id;
+            rec.addr = d.addr;
+            break;
+        case KIM_TAPE_EV_DATA:
+            if (rec.bytes < sizeof cur)
+                cur[rec.bytes++] = d.data;
+            break;
+        default:
+            records++;
+            rec.sum = d.sum;
+            rec.err = ev == KIM_TAPE_EV_END ? 0 : ev;
+            if (verbose)
+                printf("%s: %.2f s: ID %02X $%04X+%lu, CHK %04X %s\n", path,
+                       (double)i / wi.rate, rec.id, rec.addr, (unsigned long)rec.bytes,
+                       rec.sum, rec.err ? kim_tape_strerror(rec.err) : "ok");
+            if (!have && !rec.err && (!want_id || rec.id == want_id)) {
+                have = 1;
+                *found = rec;
+                memcpy(image, cur, rec.bytes);
+            }
+        }
+    }
+    if (verbose && kim_tape_in_record(&d))
+        printf("%s: ID %02X $%04X: capture ends inside the record\n", path, d.id, d.addr);
+    return records;
+}
+
+static int cmd_decode(const char *in, const char *out, int want_id)
+{
+    static uint8_t image[0x10000];
+    FILE *fi = open_or_die(in, "rb");
+    record_t rec;
+
+    int n = decode_wav(fi, in, want_id, image, &rec, 1);
+    fclose(fi);
+    if (n < 0)
+        return 1;
+    if (rec.err) {
+        fprintf(stderr, "%s: no good record%s\n", in, want_id ? " with that ID" : "");
+        return 1;
+    }
+    if (!out)
+        return 0;
+
+    FILE *fo = open_or_die(out, "wb");
+    const char *dot = strrchr(out, '.');
+    if (dot && !strcasecmp(dot, ".ptp")) {
+        char line[2 * PTP_LINE_MAX];
+        ptp_encoder_t e;
+        ptp_encoder_init(&e, rec.addr, PTP_DUMP_BYTES);
+        for (uint32_t i = 0; i < rec.bytes; i++)
+            fwrite(line, 1, ptp_encode_byte(&e, image[i], line), fo);
+        fwrite(line, 1, ptp_encode_end(&e, line), fo);
+    } else {
+        if (is_prg(out)) {
+            putc(rec.addr & 0xFF, fo);
+            putc(rec.addr >> 8, fo);
+        }
+        fwrite(image, 1, rec.bytes, fo);
+    }
+    fclose(fo);
+    printf("%s: ID %02X $%04X+%lu\n", out, rec.id, rec.addr, (unsigned long)rec.bytes);
+    return 0;
+}
+
+/* One recording: its first record must be ID id at addr, and hold
+ * exactly <name>.bin with a good checksum. */
+static int test_capture(const char *dir, const char *name, int id, unsigned addr)
+{
+    static uint8_t image[0x10000], got[0x10000];
+    char path[256];
+    record_t rec;
+
+    snprintf(path, sizeof path, "%s/%s.bin", dir, name);
+    FILE *f = open_or_die(path, "rb");
+    size_t len = fread(image, 1, sizeof image, f);
+    fclose(f);
+
+    snprintf(path, sizeof path, "%s/%s.wav", dir, name);
+    f = open_or_die(path, "rb");
+    int records = decode_wav(f, path, 0, got, &rec, 0);
+    fclose(f);
+
+    if (records < 1 || rec.err) {
+        printf("%-18s: FAIL, %s\n", path,
+               records < 1 ? "no record" : kim_tape_strerror(rec.err));
+        return 1;
+    }
+    int ok = rec.id == id && rec.addr == addr && rec.bytes == len && !memcmp(image, got, len);
+    printf("%-18s: ID %02X $%04X+%-4lu %s\n", path, rec.id, rec.addr, (unsigned long)rec.bytes,
+           ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+/* Random images through write_wav() and back through decode_wav(),
+ * then the fixture recordings. */
+static int cmd_test(const char *dir)
+{
+    static const unsigned long rates[] = { 22050, 44100, 48000 };
+    static const int noises[] = { 0, LEVEL / 4 };
+    static uint8_t in[1024], got[0x10000];
+    int fails = 0;
+
+    srand(1);
+    for (size_t r = 0; r < sizeof rates / sizeof rates[0]; r++) {
+        for (size_t n = 0; n < sizeof noises / sizeof noises[0]; n++) {
+            size_t len = 1 + rand() % sizeof in;
+            long addr = rand() % (0x10000 - (long)len);
+            int id = 1 + rand() % 0xFE;
+            unsigned long long samples;
+            record_t rec;
+
+            for (size_t i = 0; i < len; i++)
+                in[i] = (uint8_t)rand();
+
+            FILE *img = tmpfile(), *wav = tmpfile();
+            if (!img || !wav) {
+                perror("tmpfile");
+                return 1;
+            }
+            fwrite(in, 1, len, img);
+            rewind(img);
+            kim_tape_encoder_t e = write_wav(wav, img, id, addr, rates[r], noises[n], &samples);
+            rewind(wav);
+            int records = decode_wav(wav, "test", 0, got, &rec, 0);
+            fclose(img);
+            fclose(wav);
+
+            int ok = records == 1 && !rec.err && rec.id == id && rec.addr == addr &&
+                     rec.bytes == len && rec.sum == e.sum && !memcmp(in, got, len);
+            printf("%6lu Hz noise %5d: ID %02X $%04lX+%-4lu %s\n", rates[r], noises[n], id,
+                   (unsigned long)addr, (unsigned long)len, ok ? "ok" : "FAIL");
+            fails += !ok;
+        }
+    }
+    fails += test_capture(dir, "hello", 0x01, 0x0200);
+    return fails != 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: kimtape wav [-i ID] [-a ADDR] [-r RATE] IMAGE OUT.wav\n"
+            "       kimtape decode [-i ID] IN.wav [OUT.prg|OUT.bin|OUT.ptp]\n"
+            "       kimtape test [DIR]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    long addr = 0x0200;
+    int id = -1, opt; /* -1: 01 for wav, any for decode */
+    unsigned long rate = 44100;
+
+    if (argc < 2)
+        usage();
+    const char *cmd = argv[1];
+    optind = 2;
+    while ((opt = getopt(argc, argv, "i:a:r:")) != -1) {
+        switch (opt) {
+        case 'i':
+            id = (int)strtol(optarg, NULL, 16);
+            break;
+        case 'a':
+            addr = strtol(optarg, NULL, 16);
+            break;
+        case 'r':
+            rate = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            usage();
+        }
+    }
+    argv += optind;
+    argc -= optind;
+    if (id < -1 || id > 0xFF || rate < 8000)
+        usage();
+
+    if (!strcmp(cmd, "wav") && argc == 2)
+        return cmd_wav(argv[0], argv[1], id < 0 ? 0x01 : id, addr, rate);
+    if (!strcmp(cmd, "decode") && (argc == 1 || argc == 2))
+        return cmd_decode(argv[0], argc == 2 ? argv[1] : NULL, id < 0 ? 0 : id);
+    if (!strcmp(cmd, "test") && argc <= 1)
+        return cmd_test(argc ? argv[0] : "fixtures");
+    usage();
+    return 2;
+}
@@ -0,0 +1,518 @@
+/*
+ * ptptool - KIM-1 paper tapes on the host, using the firmware's own
+ * kim_ptp.c.
+ *
+ *   ptptool check TAPE             verify every record's checksum
+ *   ptptool encode [-a ADDR] [-n LEN] IMAGE TAPE
+ *                                  .bin (at ADDR, default 0200), .prg,
+ *                                  or Intel HEX / S-records (.hex .s19 ...)
+ *   ptptool decode TAPE IMAGE.prg  tape or a captured "Q" dump
+ *   ptptool bench [MB]             encoder/parser throughput, round trip
+ *   ptptool test [DIR]             the fixtures in DIR (default fixtures/)
+ *
+ * The fixtures are tapes in the monitor's punch layout: records of 24
+ * bytes, each followed by CR LF and six NULs, XOFF after the end
+ * record.  Their checksums were worked out separately from kim_ptp.c,
+ * so a mistake shared by its encoder and parser still shows up.
+ * page0300.hex (16-byte records behind an 04 record, CR LF) and
+ * page0300.s19 (32-byte S1 records, LF) are the same image again;
+ * ext02_short.hex, ext04_short.hex and long_line.hex each hold one
+ * line hex_records.c must reject.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../kim_ptp.h"
+#include "../hex_records.h"
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static FILE *open_or_die(const char *path, const char *mode)
+{
+    FILE *f = fopen(path, mode);
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    return f;
+}
+
+static int is_prg(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    return dot && strcasecmp(dot, ".prg") == 0;
+}
+
+static int cmd_check(const char *path)
+{
+    FILE *f = open_or_die(path, "rb");
+    ptp_parser_t p;
+    int c, st, errors = 0, ended = 0;
+    unsigned long bytes = 0;
+
+    ptp_parser_init(&p);
+    while (!ended && (c = getc(f)) != EOF) {
+        st = ptp_parse_char(&p, (char)c);
+        if (st == PTP_RECORD)
+            bytes += p.rec.len;
+        else if (st == PTP_END)
+            ended = 1;
+        else if (st < 0) {
+            fprintf(stderr, "%s: record %u: %s\n", path, p.records + 1, ptp_strerror(st));
+            errors++;
+        }
+    }
+    fclose(f);
+
+    printf("%s: %u records, %lu bytes%s, %d errors\n", path, p.records, bytes,
+           ended ? "" : ", no end record", errors);
+    return errors || !ended;
+}
+
+static int is_hex(const char *path)
+{
+    static const char *exts[] = {".hex", ".ihx", ".s19", ".s28", ".s37", ".srec", ".mot"};
+    const char *dot = strrchr(path, '.');
+
+    for (size_t i = 0; dot && i < sizeof exts / sizeof exts[0]; i++)
+        if (strcasecmp(dot, exts[i]) == 0)
+            return 1;
+    return 0;
+}
+
+/* Line by line, as the firmware does: merged into rec_len records.
+ * Returns 0 or the HEX_ERR_* that stopped it, with the line in
+ * *bad_line; `in` names the file in messages, NULL for none.       */
+static int encode_hex(FILE *fi, FILE *fo, const char *in, int rec_len, unsigned *bad_line)
+{
+    char text[HEX_LINE_MAX + 2], line[2 * PTP_LINE_MAX];
+    hex_parser_t h;
+    hex_data_t d;
+    ptp_encoder_t e;
+
+    hex_parser_init(&h);
+    ptp_encoder_init(&e, 0, (uint8_t)rec_len);
+
+    while (fgets(text, sizeof text, fi)) {
+        size_t len = strcspn(text, "\r\n");
+        int st = HEX_ERR_SYNTAX; /* longer than any record: the firmware stops here too */
+        if (text[len] || feof(fi))
+            st = hex_parse_line(&h, text, len, &d);
+        else
+            h.lines++;
+        if (st == HEX_END)
+            break;
+        if (st < 0) {
+            *bad_line = h.lines;
+            if (in)
+                fprintf(stderr, "%s: line %u: %s\n", in, h.lines, hex_strerror(st));
+            return st;
+        }
+        if (st != HEX_DATA || d.len == 0)
+            continue;
+
+        fwrite(line, 1, ptp_encode_seek(&e, (uint16_t)d.addr, line), fo);
+        for (int i = 0; i < d.len; i++)
+            fwrite(line, 1, ptp_encode_byte(&e, d.data[i], line), fo);
+    }
+    fwrite(line, 1, ptp_encode_end(&e, line), fo);
+
+    if (in)
+        fprintf(stderr, "%s: %u records in, %u out\n", in, h.records, e.records);
+    return 0;
+}
+
+static int cmd_encode(const char *in, const char *out, long addr, int rec_len)
+{
+    FILE *fi = open_or_die(in, "rb");
+    FILE *fo = open_or_die(out, "wb");
+    char line[2 * PTP_LINE_MAX];
+    ptp_encoder_t e;
+    int c;
+
+    if (is_hex(in)) {
+        unsigned bad_line;
+        int rc = encode_hex(fi, fo, in, rec_len ? rec_len : PTP_MERGE_BYTES, &bad_line);
+        fclose(fi);
+        fclose(fo);
+        return rc != 0;
+    }
+    if (is_prg(in)) {
+        int lo = getc(fi), hi = getc(fi);
+        addr = lo | hi << 8;
+    }
+    ptp_encoder_init(&e, (uint16_t)addr, (uint8_t)(rec_len ? rec_len : PTP_DUMP_BYTES));
+
+    while ((c = getc(fi)) != EOF) {
+        size_t n = ptp_encode_byte(&e, (uint8_t)c, line);
+        fwrite(line, 1, n, fo);
+    }
+    fwrite(line, 1, ptp_encode_end(&e, line), fo);
+
+    fclose(fi);
+    fclose(fo);
+    return 0;
+}
+
+/* Same rules as the firmware's dump capture: one range, in order,
+ * small holes zero filled.                                         */
+static int cmd_decode(const char *in, const char *out)
+{
+    FILE *fi = open_or_die(in, "rb");
+    FILE *fo = NULL;
+    ptp_parser_t p;
+    unsigned next = 0, first = 0;
+    int c, st = PTP_NONE;
+
+    ptp_parser_init(&p);
+    while (st != PTP_END && (c = getc(fi)) != EOF) {
+        st = ptp_parse_char(&p, (char)c);
+        if (st < 0) {
+            fprintf(stderr, "%s: record %u: %s\n", in, p.records + 1, ptp_strerror(st));
+            return 1;
+        }
+        if (st != PTP_RECORD)
+            continue;
+
+        if (!fo) {
+            fo = open_or_die(out, "wb");
+            first = next = p.rec.addr;
+            putc(first & 0xFF, fo);
+            putc(first >> 8, fo);
+        }
+        if (p.rec.addr < next || p.rec.addr - next > 256) {
+            fprintf(stderr, "%s: record %u at %04X, expected %04X\n", in, p.records,
+                    p.rec.addr, next);
+            return 1;
+        }
+        for (; next < p.rec.addr; next++)
+            putc(0, fo);
+        fwrite(p.rec.data, 1, p.rec.len, fo);
+        next += p.rec.len;
+    }
+    fclose(fi);
+    if (!fo) {
+        fprintf(stderr, "%s: no records\n", in);
+        return 1;
+    }
+    fclose(fo);
+
+    printf("%s: %04X-%04X, %u records%s\n", out, first, next - 1, p.records,
+           st == PTP_END ? "" : ", no end record");
+    return 0;
+}
+
+/* Punch a random image, parse the tape back and compare. */
+static int cmd_bench(long mb)
+{
+    size_t size = (size_t)mb << 20;
+    uint8_t *img = malloc(size);
+    char *tape = malloc(size * 3 + ((size >> 16) + 1) * 16); /* 61 chars per 24 bytes */
+    size_t tlen = 0, got = 0;
+    ptp_encoder_t e;
+    ptp_parser_t p;
+
+    srand(1);
+    for (size_t i = 0; i < size; i++)
+        img[i] = (uint8_t)rand();
+
+    /* one 64K image at a time, as a tape can hold no more */
+    double t0 = now_s();
+    for (size_t base = 0; base < size; base += 0x10000) {
+        ptp_encoder_init(&e, 0, PTP_DUMP_BYTES);
+        for (size_t i = base; i < base + 0x10000 && i < size; i++) {
+            size_t n = ptp_encode_byte(&e, img[i], tape + tlen);
+            tlen += n;
+        }
+        tlen += ptp_encode_end(&e, tape + tlen);
+    }
+    double t1 = now_s();
+
+    int bad = 0;
+    ptp_parser_init(&p);
+    for (size_t i = 0; i < tlen; i++) {
+        int st = ptp_parse_char(&p, tape[i]);
+        if (st == PTP_RECORD) {
+            if (got + p.rec.len > size || memcmp(img + got, p.rec.data, p.rec.len) ||
+                p.rec.addr != (got & 0xFFFF))
+                bad++;
+            got += p.rec.len;
+        } else if (st == PTP_END) {
+            p.records = 0;
+        } else if (st < 0) {
+            bad++;
+        }
+    }
+    double t2 = now_s();
+
+    printf("encode: %ld MB -> %zu bytes of tape, %.1f MB/s\n", mb, tlen, mb / (t1 - t0));
+    printf("parse:  %.1f MB of tape/s\n", tlen / 1048576.0 / (t2 - t1));
+    printf("round trip: %s (%zu of %zu bytes)\n", !bad && got == size ? "ok" : "MISMATCH", got, size);
+
+    free(img);
+    free(tape);
+    return bad || got != size;
+}
+
+static size_t slurp(const char *path, uint8_t *buf, size_t size)
+{
+    FILE *f = open_or_die(path, "rb");
+    size_t n = fread(buf, 1, size, f);
+    fclose(f);
+    return n;
+}
+
+/*
+ * One fixture: the tape must load as exactly the image at addr, and
+ * the image punched again must give the tape's records byte for byte
+ * (the NUL / XOFF padding between them aside).  bad_record > 0 says
+ * that record carries a wrong checksum; the ones before it still load.
+ */
+static int test_tape(const char *dir, const char *name, unsigned addr, unsigned bad_record)
+{
+    static uint8_t tape[16384], image[4096], loaded[4096];
+    static char want[16384], got[16384], line[2 * PTP_LINE_MAX];
+    char path[256];
+    size_t tlen, ilen, llen = 0, wlen = 0, glen = 0;
+    unsigned next = addr;
+    ptp_parser_t p;
+    ptp_encoder_t e;
+    int st = PTP_NONE, fail = 0;
+
+    snprintf(path, sizeof path, "%s/%s.ptp", dir, name);
+    tlen = slurp(path, tape, sizeof tape);
+
+    ptp_parser_init(&p);
+    for (size_t i = 0; i < tlen && st != PTP_END; i++) {
+        st = ptp_parse_char(&p, (char)tape[i]);
+        if (st == PTP_RECORD) {
+            if (p.rec.addr != next) {
+                printf("FAIL %s: record %u at %04X, expected %04X\n", name, p.records,
+                       p.rec.addr, next);
+                fail = 1;
+            }
+            memcpy(loaded + llen, p.rec.data, p.rec.len);
+            llen += p.rec.len;
+            next += p.rec.len;
+        } else if (st < 0) {
+            break;
+        }
+    }
+
+    /* the records as punched, padding left out */
+    for (size_t i = 0; i < tlen; i++)
+        if (tape[i] != 0 && tape[i] != 0x13)
+            want[wlen++] = (char)tape[i];
+
+    if (bad_record) {
+        if (st != PTP_ERR_SUM || p.records != bad_record - 1) {
+            printf("FAIL %s: want a checksum error at record %u, got \"%s\" after %u\n", name,
+                   bad_record, ptp_strerror(st), p.records);
+            return 1;
+        }
+        printf("ok   %s: record %u rejected\n", name, bad_record);
+        return fail;
+    }
+    if (st != PTP_END) {
+        printf("FAIL %s: %s after %u records\n", name,
+               st < 0 ? ptp_strerror(st) : "no end record", p.records);
+        return 1;
+    }
+
+    snprintf(path, sizeof path, "%s/%s.bin", dir, name);
+    ilen = slurp(path, image, sizeof image);
+    if (llen != ilen || memcmp(loaded, image, ilen)) {
+        printf("FAIL %s: loads %zu bytes, not the %zu of %s.bin\n", name, llen, ilen, name);
+        fail = 1;
+    }
+
+    ptp_encoder_init(&e, (uint16_t)addr, PTP_DUMP_BYTES);
+    for (size_t i = 0; i < ilen; i++) {
+        size_t n = ptp_encode_byte(&e, image[i], line);
+        memcpy(got + glen, line, n);
+        glen += n;
+    }
+    glen += ptp_encode_end(&e, got + glen);
+    if (glen != wlen || memcmp(got, want, wlen)) {
+        size_t at = 0;
+        while (at < glen && at < wlen && got[at] == want[at])
+            at++;
+        printf("FAIL %s: punched tape differs at char %zu\n", name, at);
+        fail = 1;
+    }
+
+    if (!fail)
+        printf("ok   %s: %u records, %zu bytes at %04X\n", name, p.records, ilen, addr);
+    return fail;
+}
+
+/* encode_hex() on DIR/file into tape[]; returns its status */
+static int hex_to_tape(const char *dir, const char *file, char *tape, size_t size, size_t *tlen,
+                       unsigned *bad_line)
+{
+    char path[256];
+
+    snprintf(path, sizeof path, "%s/%s", dir, file);
+    FILE *fi = open_or_die(path, "rb");
+    FILE *fo = tmpfile();
+    if (!fo) {
+        perror("tmpfile");
+        exit(1);
+    }
+    int st = encode_hex(fi, fo, NULL, PTP_MERGE_BYTES, bad_line);
+    rewind(fo);
+    *tlen = fread(tape, 1, size, fo);
+    fclose(fi);
+    fclose(fo);
+    return st;
+}
+
+/*
+ * The Intel HEX and S-record forms of one image: each must punch a
+ * tape that loads as exactly <name>.bin at addr, and the two tapes
+ * must match byte for byte, whatever the input record lengths.
+ */
+static int test_hex(const char *dir, const char *name, unsigned addr)
+{
+    static char tape[2][16384];
+    static uint8_t image[4096], loaded[4096];
+    static const char *exts[] = {"hex", "s19"};
+    char path[256], file[64];
+    size_t tlen[2], ilen, llen;
+    unsigned bad_line = 0;
+    int fail = 0;
+
+    snprintf(path, sizeof path, "%s/%s.bin", dir, name);
+    ilen = slurp(path, image, sizeof image);
+
+    for (int k = 0; k < 2; k++) {
+        snprintf(file, sizeof file, "%s.%s", name, exts[k]);
+        int st = hex_to_tape(dir, file, tape[k], sizeof tape[k], &tlen[k], &bad_line);
+        if (st) {
+            printf("FAIL %s: line %u: %s\n", file, bad_line, hex_strerror(st));
+            fail = 1;
+            continue;
+        }
+
+        ptp_parser_t p;
+        unsigned next = addr;
+        int pst = PTP_NONE;
+        llen = 0;
+        ptp_parser_init(&p);
+        for (size_t i = 0; i < tlen[k] && pst != PTP_END && pst >= 0; i++) {
+            pst = ptp_parse_char(&p, tape[k][i]);
+            if (pst != PTP_RECORD)
+                continue;
+            if (p.rec.addr != next || llen + p.rec.len > sizeof loaded) {
+                pst = PTP_ERR_ADDR;
+                break;
+            }
+            memcpy(loaded + llen, p.rec.data, p.rec.len);
+            llen += p.rec.len;
+            next += p.rec.len;
+        }
+        if (pst != PTP_END || llen != ilen || memcmp(loaded, image, ilen)) {
+            printf("FAIL %s: tape does not load as %s.bin at %04X\n", file, name, addr);
+            fail = 1;
+        } else {
+            printf("ok   %s: %u records, %zu bytes at %04X\n", file, p.records, llen, addr);
+        }
+    }
+    if (!fail && (tlen[0] != tlen[1] || memcmp(tape[0], tape[1], tlen[0]))) {
+        printf("FAIL %s: .hex and .s19 punch different tapes\n", name);
+        fail = 1;
+    }
+    return fail;
+}
+
+/* A file encode_hex() must stop on, with status want at line want_line. */
+static int test_hex_error(const char *dir, const char *file, int want, unsigned want_line)
+{
+    static char tape[16384];
+    size_t tlen;
+    unsigned bad_line = 0;
+
+    int st = hex_to_tape(dir, file, tape, sizeof tape, &tlen, &bad_line);
+    if (st != want || bad_line != want_line) {
+        printf("FAIL %s: want \"%s\" at line %u, got \"%s\" at line %u\n", file,
+               hex_strerror(want), want_line, st ? hex_strerror(st) : "no error", bad_line);
+        return 1;
+    }
+    printf("ok   %s: line %u rejected\n", file, bad_line);
+    return 0;
+}
+
+static int cmd_test(const char *dir)
+{
+    int fail = 0;
+
+    fail |= test_tape(dir, "hello", 0x0200, 0);
+    fail |= test_tape(dir, "page0300", 0x0300, 0);
+    fail |= test_tape(dir, "hello_badsum", 0x0200, 2);
+    fail |= test_hex(dir, "page0300", 0x0300);
+    fail |= test_hex_error(dir, "ext02_short.hex", HEX_ERR_SYNTAX, 2);
+    fail |= test_hex_error(dir, "ext04_short.hex", HEX_ERR_SYNTAX, 2);
+    fail |= test_hex_error(dir, "long_line.hex", HEX_ERR_SYNTAX, 3);
+    return fail;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: ptptool check TAPE\n"
+            "       ptptool encode [-a ADDR] [-n LEN] IMAGE TAPE\n"
+            "       ptptool decode TAPE IMAGE.prg\n"
+            "       ptptool bench [MB]\n"
+            "       ptptool test [DIR]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    long addr = 0x0200;
+    int rec_len = 0, opt; /* 0: per input type */
+
+    if (argc < 2)
+        usage();
+    const char *cmd = argv[1];
+    optind = 2;
+    while ((opt = getopt(argc, argv, "a:n:")) != -1) {
+        switch (opt) {
+        case 'a':
+            addr = strtol(optarg, NULL, 16);
+            break;
+        case 'n':
+            rec_len = atoi(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+    argv += optind;
+    argc -= optind;
+    if (rec_len < 0 || rec_len > PTP_MAX_DATA)
+        usage();
+
+    if (!strcmp(cmd, "check") && argc == 1)
+        return cmd_check(argv[0]);
+    if (!strcmp(cmd, "encode") && argc == 2)
+        return cmd_encode(argv[0], argv[1], addr, rec_len);
+    if (!strcmp(cmd, "decode") && argc == 2)
+        return cmd_decode(argv[0], argv[1]);
+    if (!strcmp(cmd, "bench") && argc <= 1)
+        return cmd_bench(argc ? atol(argv[0]) : 16);
+    if (!strcmp(cmd, "test") && argc <= 1)
+        return cmd_test(argc ? argv[0] : "fixtures");
+    usage();
+    return 2;
+}
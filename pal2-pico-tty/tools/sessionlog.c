@@ -0,0 +1,370 @@
+/*
+ * sessionlog - read the PAL-2 session logs (.psl) written by
+ * session_log.c.
+ *
+ *   sessionlog index  LOG           header, trailer and time index
+ *   sessionlog dump   [-s SEC] LOG  every run as text
+ *   sessionlog replay [-s SEC] [-x SPEED] [-n] LOG
+ *                                   PAL output into a new pty, with the
+ *                                   original timing divided by SPEED
+ */
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../session_log_format.h"
+
+typedef struct {
+    FILE *f;
+    session_file_header_t hdr;
+    session_trailer_t tr;
+    int has_index;
+    uint32_t *index;
+    uint32_t blocks;
+} log_t;
+
+typedef struct {
+    uint64_t t_us; /* session time of the first byte */
+    uint32_t span_us;
+    uint8_t dir;
+    uint32_t len;
+    const uint8_t *data;
+} run_t;
+
+/* called per run; non-zero stops the walk */
+typedef int (*run_fn)(const run_t *r, void *ctx);
+
+static const char *dir_name[] = {"PAL ", "HOST", "UPLD", "BAUD"};
+
+static void die(const char *msg)
+{
+    fprintf(stderr, "sessionlog: %s\n", msg);
+    exit(1);
+}
+
+static int log_open(log_t *lg, const char *path)
+{
+    memset(lg, 0, sizeof *lg);
+    lg->f = fopen(path, "rb");
+    if (!lg->f) {
+        perror(path);
+        return -1;
+    }
+    if (fread(&lg->hdr, sizeof lg->hdr, 1, lg->f) != 1 || lg->hdr.magic != SESSION_FILE_MAGIC) {
+        fprintf(stderr, "%s: not a session log\n", path);
+        return -1;
+    }
+    if (lg->hdr.version != SESSION_VERSION || lg->hdr.block_size != SESSION_BLOCK_SIZE) {
+        fprintf(stderr, "%s: version %u, block size %u not supported\n", path,
+                lg->hdr.version, lg->hdr.block_size);
+        return -1;
+    }
+
+    fseek(lg->f, 0, SEEK_END);
+    long size = ftell(lg->f);
+
+    /* A log that was never stopped has no trailer; count whole blocks */
+    if (size >= (long)(lg->hdr.header_size + sizeof lg->tr) &&
+        fseek(lg->f, size - (long)sizeof lg->tr, SEEK_SET) == 0 &&
+        fread(&lg->tr, sizeof lg->tr, 1, lg->f) == 1 &&
+        lg->tr.magic == SESSION_INDEX_MAGIC) {
+        lg->has_index = 1;
+        lg->blocks = lg->tr.blocks;
+        lg->index = calloc(lg->tr.entries + 1, sizeof *lg->index);
+        fseek(lg->f, size - (long)sizeof lg->tr - (long)(lg->tr.entries * sizeof *lg->index), SEEK_SET);
+        if (fread(lg->index, sizeof *lg->index, lg->tr.entries, lg->f) != lg->tr.entries)
+            die("short index");
+    } else {
+        lg->blocks = (uint32_t)((size - lg->hdr.header_size) / lg->hdr.block_size);
+    }
+    return 0;
+}
+
+static int read_block(log_t *lg, uint32_t n, uint8_t *buf)
+{
+    const session_block_header_t *bh = (const session_block_header_t *)buf;
+
+    if (fseek(lg->f, lg->hdr.header_size + (long)n * lg->hdr.block_size, SEEK_SET) != 0 ||
+        fread(buf, lg->hdr.block_size, 1, lg->f) != 1)
+        return -1;
+    if (bh->magic != SESSION_BLOCK_MAGIC || bh->seq != n ||
+        bh->used > lg->hdr.block_size - sizeof *bh)
+        return -1;
+    return 0;
+}
+
+static uint64_t block_t0(log_t *lg, uint32_t n)
+{
+    static uint8_t buf[SESSION_BLOCK_SIZE];
+    return read_block(lg, n, buf) == 0 ? ((session_block_header_t *)buf)->t0_us : UINT64_MAX;
+}
+
+/* Last block starting at or before t_us: the index narrows it down,
+ * then a binary search over block headers finishes the job (or does
+ * all of it when the trailer is missing).                            */
+static uint32_t find_block(log_t *lg, uint64_t t_us)
+{
+    uint32_t lo = 0, hi = lg->blocks;
+
+    if (lg->has_index && lg->tr.entries) {
+        uint32_t i = 0;
+        while (i + 1 < lg->tr.entries && (uint64_t)lg->index[i + 1] * 1000 <= t_us)
+            i++;
+        lo = i * lg->tr.stride;
+        hi = i + 1 < lg->tr.entries ? (i + 1) * lg->tr.stride : lg->blocks;
+    }
+
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (block_t0(lg, mid) <= t_us)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int get_varint(const uint8_t **p, const uint8_t *end, uint64_t *v)
+{
+    *v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        uint8_t b = *(*p)++;
+        *v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return 0;
+    }
+    return -1;
+}
+
+static void walk(log_t *lg, uint64_t from_us, run_fn fn, void *ctx)
+{
+    static uint8_t buf[SESSION_BLOCK_SIZE];
+
+    for (uint32_t n = find_block(lg, from_us); n < lg->blocks; n++) {
+        if (read_block(lg, n, buf) != 0) {
+            fprintf(stderr, "sessionlog: block %u unreadable, stopping\n", n);
+            return;
+        }
+
+        const session_block_header_t *bh = (const session_block_header_t *)buf;
+        const uint8_t *p = buf + sizeof *bh;
+        const uint8_t *end = p + bh->used;
+        uint64_t t = bh->t0_us;
+
+        for (uint32_t i = 0; i < bh->runs; i++) {
+            uint64_t tag, len, span;
+            run_t r;
+
+            if (get_varint(&p, end, &tag) || get_varint(&p, end, &len) ||
+                get_varint(&p, end, &span) || len > (uint64_t)(end - p)) {
+                fprintf(stderr, "sessionlog: block %u corrupt at run %u\n", n, i);
+                break;
+            }
+            t += tag >> 2;
+            r.t_us = t;
+            r.dir = tag & 3;
+            r.len = (uint32_t)len;
+            r.span_us = (uint32_t)span;
+            r.data = p;
+            p += len;
+
+            if (r.t_us >= from_us && fn(&r, ctx))
+                return;
+        }
+    }
+}
+
+/* ---- index -------------------------------------------------------- */
+
+static int cmd_index(log_t *lg)
+{
+    printf("start      %llu us after boot\n", (unsigned long long)lg->hdr.start_us);
+    printf("baud       %u\n", lg->hdr.baud);
+    printf("blocks     %u x %u bytes\n", lg->blocks, lg->hdr.block_size);
+    if (!lg->has_index) {
+        printf("no index (log was not stopped cleanly)\n");
+        return 0;
+    }
+    printf("length     %u.%03u s\n", lg->tr.end_ms / 1000, lg->tr.end_ms % 1000);
+    printf("index      %u entries, %u blocks each\n", lg->tr.entries, lg->tr.stride);
+    for (uint32_t i = 0; i < lg->tr.entries; i++)
+        printf("  block %6u  %8u.%03u s\n", i * lg->tr.stride,
+               lg->index[i] / 1000, lg->index[i] % 1000);
+    return 0;
+}
+
+/* ---- dump --------------------------------------------------------- */
+
+static int dump_run(const run_t *r, void *ctx)
+{
+    (void)ctx;
+    printf("%6llu.%06llu %s ", (unsigned long long)(r->t_us / 1000000),
+           (unsigned long long)(r->t_us % 1000000), dir_name[r->dir]);
+
+    if (r->dir == SESSION_DIR_BAUD) {
+        uint32_t baud = r->len == 4 ? r->data[0] | r->data[1] << 8 | r->data[2] << 16 |
+                                          (uint32_t)r->data[3] << 24
+                                    : 0;
+        printf("%u\n", baud);
+        return 0;
+    }
+
+    putchar('"');
+    for (uint32_t i = 0; i < r->len; i++) {
+        uint8_t c = r->data[i];
+        if (c == '\r')
+            fputs("\\r", stdout);
+        else if (c == '\n')
+            fputs("\\n", stdout);
+        else if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < ' ' || c >= 0x7F)
+            printf("\\x%02X", c);
+        else
+            putchar(c);
+    }
+    printf("\" %u/%uus\n", r->len, r->span_us);
+    return 0;
+}
+
+/* ---- replay ------------------------------------------------------- */
+
+typedef struct {
+    int fd;
+    double speed;
+    uint64_t first_us; /* session time that maps to wall_start */
+    struct timespec wall_start;
+    int started;
+} replay_t;
+
+static void sleep_until(const replay_t *rp, uint64_t t_us)
+{
+    uint64_t due_ns = (uint64_t)((double)(t_us - rp->first_us) * 1000.0 / rp->speed);
+    struct timespec ts = rp->wall_start;
+
+    ts.tv_sec += due_ns / 1000000000u;
+    ts.tv_nsec += due_ns % 1000000000u;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static int replay_run(const run_t *r, void *ctx)
+{
+    replay_t *rp = ctx;
+
+    if (r->dir != SESSION_DIR_PAL)
+        return 0;
+    if (!rp->started) {
+        rp->first_us = r->t_us;
+        clock_gettime(CLOCK_MONOTONIC, &rp->wall_start);
+        rp->started = 1;
+    }
+
+    /* bytes of a run are spread evenly over its span */
+    for (uint32_t i = 0; i < r->len; i++) {
+        uint64_t t = r->t_us + (r->len > 1 ? (uint64_t)r->span_us * i / (r->len - 1) : 0);
+        sleep_until(rp, t);
+        if (write(rp->fd, &r->data[i], 1) != 1)
+            return errno != EAGAIN; /* EIO: the other end went away */
+    }
+    return 0;
+}
+
+static int cmd_replay(log_t *lg, uint64_t from_us, double speed, int wait)
+{
+    replay_t rp = {.speed = speed};
+    struct termios tio;
+
+    rp.fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (rp.fd < 0 || grantpt(rp.fd) || unlockpt(rp.fd))
+        die("cannot create a pty");
+
+    /* Hold the slave open ourselves so readers can come and go, and
+     * make it raw so CR/LF reach them exactly as the PAL sent them. */
+    const char *name = ptsname(rp.fd);
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0 || tcgetattr(slave, &tio))
+        die("cannot open the pty slave");
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    printf("replaying PAL output on %s at x%g\n", name, speed);
+    if (wait) {
+        printf("press Enter to start\n");
+        fflush(stdout);
+        getchar();
+    }
+    fflush(stdout);
+
+    walk(lg, from_us, replay_run, &rp);
+    tcdrain(rp.fd);
+    close(slave);
+    close(rp.fd);
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: sessionlog index LOG\n"
+            "       sessionlog dump [-s SEC] LOG\n"
+            "       sessionlog replay [-s SEC] [-x SPEED] [-n] LOG\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    double from_s = 0, speed = 1;
+    int wait = 1, opt;
+    log_t lg;
+
+    if (argc < 3)
+        usage();
+    const char *cmd = argv[1];
+    optind = 2;
+
+    while ((opt = getopt(argc, argv, "s:x:n")) != -1) {
+        switch (opt) {
+        case 's':
+            from_s = atof(optarg);
+            break;
+        case 'x':
+            speed = atof(optarg);
+            break;
+        case 'n':
+            wait = 0;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1 || speed <= 0 || from_s < 0)
+        usage();
+    if (log_open(&lg, argv[optind]))
+        return 1;
+
+    uint64_t from_us = (uint64_t)(from_s * 1e6);
+
+    if (strcmp(cmd, "index") == 0)
+        return cmd_index(&lg);
+    if (strcmp(cmd, "dump") == 0) {
+        walk(&lg, from_us, dump_run, NULL);
+        return 0;
+    }
+    if (strcmp(cmd, "replay") == 0)
+        return cmd_replay(&lg, from_us, speed, wait);
+    usage();
+    return 2;
+}
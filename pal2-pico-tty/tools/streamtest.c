@@ -0,0 +1,163 @@
+/*
+ * streamtest - the firmware's file_stream.c against an in-memory
+ * f_read, so what send_file() and the tape deck hand the pacer can
+ * be checked byte for byte on the host.
+ *
+ *   streamtest       run every case; exit status 1 on a failure
+ *
+ * Cases: lines longer than 255 bytes, lines across a block boundary,
+ * a last line without CR/LF, files ending on and off a block
+ * boundary, an empty file, and an f_read error part way.  Each runs
+ * with and without prefetch calls between bytes, as the pacer's
+ * waits would make them.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../file_stream.h"
+
+/* The file f_read serves: all of `src`, or an error at `fail_at`. */
+static const uint8_t *src;
+static size_t src_len;
+static size_t src_pos;
+static long fail_at = -1;
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+    (void)fp;
+    *br = 0;
+    if (fail_at >= 0 && src_pos + btr > (size_t)fail_at)
+        return FR_DISK_ERR;
+
+    size_t n = src_len - src_pos;
+    if (n > btr)
+        n = btr;
+    memcpy(buff, src + src_pos, n);
+    src_pos += n;
+    *br = n;
+    return FR_OK;
+}
+
+static int failures;
+
+static void check(int ok, const char *name, const char *what)
+{
+    if (!ok) {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+/*
+ * Stream `data` through file_stream and compare.  prefetch_every is
+ * how many bytes go by between file_stream_prefetch() calls, 0 for
+ * none.  With fail >= 0, f_read fails at that offset and the stream
+ * must stop short with s.err set instead of looking like a clean EOF.
+ */
+static void run(const char *name, const uint8_t *data, size_t len, int prefetch_every,
+                long fail)
+{
+    static file_stream_t s;
+    static uint8_t got[8192];
+    FIL fp;
+    size_t n = 0;
+    int c;
+
+    src = data;
+    src_len = len;
+    src_pos = 0;
+    fail_at = fail;
+
+    file_stream_open(&s, &fp);
+    while ((c = file_stream_getc(&s)) >= 0) {
+        if (n == sizeof got) {
+            check(0, name, "runs past the end of the file");
+            return;
+        }
+        got[n++] = (uint8_t)c;
+        if (prefetch_every && n % prefetch_every == 0)
+            file_stream_prefetch(&s);
+    }
+
+    check(file_stream_getc(&s) < 0, name, "getc after EOF returns data");
+    check(s.consumed == n, name, "consumed does not match bytes returned");
+
+    if (fail >= 0) {
+        /* whole blocks before the failing read get through, no more */
+        size_t ok_bytes = (size_t)fail / STREAM_BLOCK_SIZE * STREAM_BLOCK_SIZE;
+        check(s.err != FR_OK, name, "read error not reported");
+        check(n <= ok_bytes + STREAM_BLOCK_SIZE && n <= len, name, "bytes past the error");
+        check(memcmp(got, data, n) == 0, name, "data before the error differs");
+        return;
+    }
+
+    check(s.err == FR_OK, name, "error on a clean file");
+    check(n == len, name, "length differs");
+    check(memcmp(got, data, n < len ? n : len) == 0, name, "data differs");
+}
+
+/* Lines of the given lengths (CR LF after each but maybe the last) */
+static size_t make_lines(uint8_t *out, const size_t *lens, int count, int last_eol)
+{
+    size_t n = 0;
+
+    for (int i = 0; i < count; i++) {
+        for (size_t k = 0; k < lens[i]; k++)
+            out[n++] = 'A' + (i + k) % 26;
+        if (i < count - 1 || last_eol) {
+            out[n++] = '\r';
+            out[n++] = '\n';
+        }
+    }
+    return n;
+}
+
+int main(void)
+{
+    static uint8_t buf[8192];
+    static const int prefetch[] = {0, 1, 7, 512};
+    struct {
+        const char *name;
+        size_t lens[6];
+        int count;
+        int last_eol;
+    } cases[] = {
+        {"long lines", {300, 256, 1000, 10}, 4, 1},
+        {"line across block", {500, 40, 600}, 3, 1},
+        {"no final eol", {20, 700, 33}, 3, 0},
+        {"ends on block", {510}, 1, 1},
+        {"ends on 2 blocks", {1022}, 1, 1},
+        {"one byte", {1}, 1, 0},
+        {"empty", {0}, 1, 0},
+    };
+
+    for (size_t i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+        size_t len = make_lines(buf, cases[i].lens, cases[i].count, cases[i].last_eol);
+        for (size_t p = 0; p < sizeof prefetch / sizeof prefetch[0]; p++) {
+            char name[64];
+            snprintf(name, sizeof name, "%s (%zu bytes, prefetch %d)", cases[i].name, len,
+                     prefetch[p]);
+            run(name, buf, len, prefetch[p], -1);
+        }
+    }
+
+    /* the whole file must not look sent when a read fails */
+    size_t lens[] = {2000};
+    size_t len = make_lines(buf, lens, 1, 1);
+    static const long fails[] = {0, 100, 512, 1500};
+    for (size_t f = 0; f < sizeof fails / sizeof fails[0]; f++) {
+        for (size_t p = 0; p < sizeof prefetch / sizeof prefetch[0]; p++) {
+            char name[64];
+            snprintf(name, sizeof name, "read error at %ld (prefetch %d)", fails[f], prefetch[p]);
+            run(name, buf, len, prefetch[p], fails[f]);
+        }
+    }
+
+    if (failures) {
+        printf("%d failed\n", failures);
+        return 1;
+    }
+    printf("all passed\n");
+    return 0;
+}
@@ -0,0 +1,422 @@
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "uart_bridge.h"
+#include "spsc_ring.h"
+#include "proj_hw.h"
+#include "debug.h"
+
+/* ----------------------------------------------------------------
+ *  Per‑build tuning — adjust to taste
+ * ---------------------------------------------------------------- */
+#define BRIDGE_RX_RING_SIZE 1024 // PAL->USB, filled from the UART IRQ
+#define BRIDGE_TX_RING_SIZE 512  // USB->PAL, drained as the UART frees up
+#define BRIDGE_UP_RING_SIZE 512  // core 0 (uploads)->PAL
+#define BRIDGE_USB_CHUNK 64      // one CDC bulk packet
+#define BRIDGE_MAX_TAPS 4
+
+/* Keep an arrival stamp per ring slot so the stats page can report a
+ * true worst‑case per‑byte latency.  Costs 4 bytes of RAM per slot.   */
+#define BRIDGE_TRACK_LATENCY true
+
+static uint8_t rx_storage[BRIDGE_RX_RING_SIZE];
+static uint8_t tx_storage[BRIDGE_TX_RING_SIZE];
+static uint8_t up_storage[BRIDGE_UP_RING_SIZE];
+static spsc_ring_t rx_ring; // PAL->USB
+static spsc_ring_t tx_ring; // USB->PAL
+static spsc_ring_t up_ring; // core 0->PAL, the only ring that crosses cores
+
+#if BRIDGE_TRACK_LATENCY
+static uint32_t rx_stamp[BRIDGE_RX_RING_SIZE];
+static uint32_t tx_stamp[BRIDGE_TX_RING_SIZE];
+#endif
+
+/* The stats are only ever written on core 1; core 0 asks for a reset
+ * through this flag instead of clearing them under its feet.        */
+static bridge_stats_t stats;
+static volatile bool reset_requested;
+
+static uint32_t link_baud; // current PAL_UART rate, core 0 owned
+
+static bridge_tap_t *volatile taps[BRIDGE_MAX_TAPS];
+static volatile uint32_t pump_passes; // lets core 0 wait out a pass
+
+static volatile uint32_t first_byte_us; // 0 until something crosses the bridge
+
+static volatile bridge_job_t job; // set by core 0, run by core 1
+static void *volatile job_ctx;
+
+/* Stamped taps only: RX pushes come from the IRQ, so TX pushes mask
+ * it to keep each tap ring single‑producer.                          */
+static inline void tap_event(bridge_tap_t *tap, uint8_t dir, uint8_t c, uint32_t now)
+{
+    bridge_event_t ev = {.t_us = now, .dir = dir, .c = c};
+    if (!spsc_ring_write(&tap->ring, &ev, sizeof ev))
+        tap->dropped++;
+}
+
+static void __not_in_flash_func(tap_tx)(uint8_t dir, uint8_t c)
+{
+    uint32_t now = time_us_32();
+
+    for (int i = 0; i < BRIDGE_MAX_TAPS; i++)
+    {
+        bridge_tap_t *tap = taps[i];
+        if (tap && tap->stamped)
+        {
+            uint32_t flags = save_and_disable_interrupts();
+            tap_event(tap, dir, c, now);
+            restore_interrupts(flags);
+        }
+    }
+}
+
+static inline void note_latency(bridge_dir_stats_t *dir, uint32_t since)
+{
+    uint32_t lat = time_us_32() - since;
+    if (lat > dir->max_latency_us)
+        dir->max_latency_us = lat;
+}
+
+/* Empty the PAL UART hardware FIFO into rx_ring.  Runs from the IRQ,
+ * and from the pump with interrupts masked, so there is only ever one
+ * producer at a time.                                                */
+static void __not_in_flash_func(drain_pal_uart)(void)
+{
+    uart_hw_t *hw = uart_get_hw(PAL_UART);
+
+    while (!(hw->fr & UART_UARTFR_RXFE_BITS))
+    {
+        uint32_t dr = hw->dr;
+        if (dr & UART_UARTDR_OE_BITS)
+            stats.uart_overruns++;
+
+        if (spsc_ring_space(&rx_ring) == 0)
+        {
+            stats.pal_to_usb.dropped++;
+        }
+        else
+        {
+#if BRIDGE_TRACK_LATENCY
+            /* only a free slot: when full, head's slot is the oldest unread byte's */
+            rx_stamp[rx_ring.head & rx_ring.mask] = time_us_32();
+#endif
+            spsc_ring_push(&rx_ring, (uint8_t)dr); // stamp first: the push publishes both
+        }
+
+        for (int i = 0; i < BRIDGE_MAX_TAPS; i++)
+        {
+            bridge_tap_t *tap = taps[i];
+            if (!tap)
+                continue;
+            if (tap->stamped)
+                tap_event(tap, BRIDGE_DIR_PAL_TO_USB, (uint8_t)dr, time_us_32());
+            else if (!spsc_ring_push(&tap->ring, (uint8_t)dr))
+                tap->dropped++;
+        }
+    }
+}
+
+static void __not_in_flash_func(on_pal_uart_irq)(void)
+{
+    drain_pal_uart();
+}
+
+static void clear_stats(void)
+{
+    memset(&stats, 0, sizeof stats);
+    stats.since_us = time_us_64();
+}
+
+/* Everything the pump touches lives on core 1: the UART IRQ is
+ * enabled from here so it lands on this core's NVIC, and the UI on
+ * core 0 can block on I2C or the SD card without stalling the link.  */
+static void bridge_core1_entry(void)
+{
+    multicore_lockout_victim_init(); // hw_cache_flush() parks this core to write flash
+
+    int irq = PAL_UART == uart0 ? UART0_IRQ : UART1_IRQ;
+    irq_set_exclusive_handler(irq, on_pal_uart_irq);
+    irq_set_enabled(irq, true);
+
+    // RX data + RX timeout; TX is pumped from uart_bridge_task()
+    uart_set_irq_enables(PAL_UART, true, false);
+
+    while (true)
+    {
+        bool busy = uart_bridge_task();
+
+        bridge_job_t j = job;
+        if (j && j(job_ctx))
+            busy = true;
+
+        if (!busy)
+        {
+            tight_loop_contents();
+        }
+    }
+}
+
+void uart_bridge_init(void)
+{
+    spsc_ring_init(&rx_ring, rx_storage, sizeof rx_storage);
+    spsc_ring_init(&tx_ring, tx_storage, sizeof tx_storage);
+    spsc_ring_init(&up_ring, up_storage, sizeof up_storage);
+    clear_stats();
+    reset_requested = false;
+    link_baud = BAUD_RATE;
+
+    multicore_launch_core1(bridge_core1_entry);
+}
+
+/* ----------------------------------------------------------------
+ *  uart_bridge_task()
+ *  – core 1 only; non‑blocking, called back to back by the pump.
+ *    Returns true if any byte moved in either direction.
+ * ---------------------------------------------------------------- */
+bool uart_bridge_task(void)
+{
+    bool busy = false;
+
+    if (reset_requested)
+    {
+        clear_stats();
+        reset_requested = false;
+    }
+
+    /* Pick up anything still below the FIFO IRQ threshold now rather
+     * than waiting out the 32‑bit receive timeout.                    */
+    uint32_t flags = save_and_disable_interrupts();
+    drain_pal_uart();
+    restore_interrupts(flags);
+
+    /* PAL->USB, one contiguous chunk per call */
+    const uint8_t *p;
+    uint32_t n = spsc_ring_peek(&rx_ring, &p);
+    if (n)
+    {
+        n = MIN(n, BRIDGE_USB_CHUNK);
+#if BRIDGE_TRACK_LATENCY
+        // the oldest byte in the chunk has waited the longest
+        note_latency(&stats.pal_to_usb, rx_stamp[rx_ring.tail & rx_ring.mask]);
+#endif
+        stdio_put_string((const char *)p, n, false, false);
+        spsc_ring_consume(&rx_ring, n);
+        stats.pal_to_usb.bytes += n;
+        busy = true;
+    }
+
+    /* USB->tx_ring, never more than the ring can take */
+    uint32_t space = MIN(spsc_ring_space(&tx_ring), BRIDGE_USB_CHUNK);
+    if (space)
+    {
+        char buf[BRIDGE_USB_CHUNK];
+        int got = stdio_get_until(buf, space, get_absolute_time());
+        for (int i = 0; i < got; i++)
+        {
+#if BRIDGE_TRACK_LATENCY
+            tx_stamp[tx_ring.head & tx_ring.mask] = time_us_32();
+#endif
+            if (!spsc_ring_push(&tx_ring, (uint8_t)buf[i]))
+                stats.usb_to_pal.dropped++;
+        }
+    }
+
+    /* up_ring->PAL first: an upload in progress owns the line */
+    while (uart_is_writable(PAL_UART) && spsc_ring_count(&up_ring))
+    {
+        uint8_t c;
+        spsc_ring_pop(&up_ring, &c);
+        uart_putc_raw(PAL_UART, (char)c);
+        tap_tx(BRIDGE_DIR_UPLOAD, c);
+        stats.upload_bytes++;
+        busy = true;
+    }
+
+    /* tx_ring->PAL, only as much as the UART FIFO will take */
+    while (uart_is_writable(PAL_UART) && spsc_ring_count(&tx_ring))
+    {
+        uint8_t c;
+#if BRIDGE_TRACK_LATENCY
+        note_latency(&stats.usb_to_pal, tx_stamp[tx_ring.tail & tx_ring.mask]);
+#endif
+        spsc_ring_pop(&tx_ring, &c);
+        uart_putc_raw(PAL_UART, (char)c);
+        tap_tx(BRIDGE_DIR_USB_TO_PAL, c);
+        stats.usb_to_pal.bytes++;
+        busy = true;
+    }
+
+    if (busy && !first_byte_us)
+        first_byte_us = time_us_32() | 1; // the boot trace's end point
+
+    pump_passes++;
+    return busy;
+}
+
+/* ----------------------------------------------------------------
+ *  uart_bridge_putc()
+ *  – core 0 side of up_ring.  Waits for room rather than dropping,
+ *    so an upload is paced by the UART, never truncated.
+ * ---------------------------------------------------------------- */
+void uart_bridge_putc(uint8_t c)
+{
+    while (!spsc_ring_push(&up_ring, c))
+    {
+        tight_loop_contents();
+    }
+}
+
+/* True once every queued upload byte has been handed to the UART. */
+bool uart_bridge_tx_idle(void)
+{
+    return spsc_ring_count(&up_ring) == 0;
+}
+
+/* ----------------------------------------------------------------
+ *  uart_bridge_tap_attach() / uart_bridge_tap_detach()
+ *  – core 0 only.  Publishing the pointer is a single word store;
+ *    detach waits out two pump passes so core 1 (IRQ included) is
+ *    done with the ring before the caller reuses its storage.
+ * ---------------------------------------------------------------- */
+static bool tap_attach(bridge_tap_t *tap, uint8_t *storage, uint32_t size, bool stamped)
+{
+    spsc_ring_init(&tap->ring, storage, size);
+    tap->dropped = 0;
+    tap->stamped = stamped;
+    __dmb();
+
+    for (int i = 0; i < BRIDGE_MAX_TAPS; i++)
+    {
+        if (taps[i] == NULL)
+        {
+            taps[i] = tap;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool uart_bridge_tap_attach(bridge_tap_t *tap, uint8_t *storage, uint32_t size)
+{
+    return tap_attach(tap, storage, size, false);
+}
+
+/* `size` should be a multiple of sizeof(bridge_event_t). */
+bool uart_bridge_tap_attach_stamped(bridge_tap_t *tap, uint8_t *storage, uint32_t size)
+{
+    return tap_attach(tap, storage, size, true);
+}
+
+void uart_bridge_tap_detach(bridge_tap_t *tap)
+{
+    for (int i = 0; i < BRIDGE_MAX_TAPS; i++)
+    {
+        if (taps[i] == tap)
+        {
+            taps[i] = NULL;
+        }
+    }
+
+    uint32_t pass = pump_passes;
+    while (pump_passes - pass < 2)
+    {
+        tight_loop_contents();
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  uart_bridge_job_attach() / uart_bridge_job_detach()
+ *  – give core 1 something to do between passes, e.g. decoding a
+ *    capture in real time while core 0 sits on the SD card.  Detach
+ *    returns once the job can no longer be running.
+ * ---------------------------------------------------------------- */
+bool uart_bridge_job_attach(bridge_job_t j, void *ctx)
+{
+    if (job)
+        return false;
+
+    job_ctx = ctx;
+    __dmb(); // ctx before the job that reads it
+    job = j;
+    return true;
+}
+
+void uart_bridge_job_detach(void)
+{
+    job = NULL;
+
+    uint32_t pass = pump_passes;
+    while (pump_passes - pass < 2)
+    {
+        tight_loop_contents();
+    }
+}
+
+/* Every queued upload byte is off the wire, stop bit included. */
+void uart_bridge_wait_tx_done(void)
+{
+    while (!uart_bridge_tx_idle())
+    {
+        tight_loop_contents();
+    }
+    uart_tx_wait_blocking(PAL_UART);
+}
+
+/* ----------------------------------------------------------------
+ *  uart_bridge_set_baud()
+ *  – retime PAL_UART between characters.  Queued upload bytes go out
+ *    at the old rate first.  Returns the rate actually set.
+ * ---------------------------------------------------------------- */
+uint32_t uart_bridge_set_baud(uint32_t baud)
+{
+    uart_bridge_wait_tx_done();
+
+    link_baud = uart_set_baudrate(PAL_UART, baud);
+    debug_printf("PAL link now %lu baud\n", (unsigned long)link_baud);
+    return link_baud;
+}
+
+/* ----------------------------------------------------------------
+ *  uart_bridge_set_stop_bits()
+ *  – 8N1 or 8N2 on PAL_UART, switched between characters like the
+ *    baud rate.  A second stop bit gives a bit‑banged receiver on
+ *    the PAL time to store each byte.
+ * ---------------------------------------------------------------- */
+void uart_bridge_set_stop_bits(uint bits)
+{
+    uart_bridge_wait_tx_done();
+
+    uart_set_format(PAL_UART, 8, bits, UART_PARITY_NONE);
+}
+
+uint32_t uart_bridge_get_baud(void)
+{
+    return link_baud;
+}
+
+/* time_us_32() when the first byte went through either way, or 0 */
+uint32_t uart_bridge_first_byte_us(void)
+{
+    return first_byte_us;
+}
+
+void uart_bridge_get_stats(bridge_stats_t *out)
+{
+    // written by core 1 only; a torn copy just skews one refresh
+    *out = stats;
+}
+
+void uart_bridge_reset_stats(void)
+{
+    reset_requested = true;
+    while (reset_requested)
+    {
+        tight_loop_contents();
+    }
+}
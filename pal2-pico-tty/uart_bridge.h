@@ -0,0 +1,79 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "pico/stdlib.h"
+#include "spsc_ring.h"
+
+    typedef struct
+    {
+        uint32_t bytes;          // bytes forwarded
+        uint32_t dropped;        // bytes lost because a ring was full
+        uint32_t max_latency_us; // worst wait between arrival and hand‑off
+    } bridge_dir_stats_t;
+
+    typedef struct
+    {
+        bridge_dir_stats_t pal_to_usb;
+        bridge_dir_stats_t usb_to_pal;
+        uint32_t upload_bytes;  // bytes queued by core 0 via uart_bridge_putc()
+        uint32_t uart_overruns; // PAL UART hardware FIFO overruns
+        uint64_t since_us;      // start of the measurement window
+    } bridge_stats_t;
+
+    /* A tap receives a copy of every PAL->USB byte.  Core 1 produces
+     * into `ring`, the core 0 owner consumes it.  A stamped tap gets
+     * a bridge_event_t per byte instead, for both directions.        */
+    typedef struct
+    {
+        spsc_ring_t ring;
+        volatile uint32_t dropped; // copies lost because `ring` was full
+        bool stamped;
+    } bridge_tap_t;
+
+    enum
+    {
+        BRIDGE_DIR_PAL_TO_USB, // PAL output, as the host sees it
+        BRIDGE_DIR_USB_TO_PAL, // typed or sent by the host
+        BRIDGE_DIR_UPLOAD,     // queued by core 0 via uart_bridge_putc()
+    };
+
+    typedef struct
+    {
+        uint32_t t_us; // time_us_32() on the wire (TX) or out of the FIFO (RX)
+        uint8_t dir;
+        uint8_t c;
+    } bridge_event_t;
+
+    /* Extra work for core 1, run between pump passes: short and
+     * non-blocking, true if it did anything.  One at a time.        */
+    typedef bool (*bridge_job_t)(void *ctx);
+
+    void uart_bridge_init(void);
+    bool uart_bridge_task(void);
+
+    void uart_bridge_putc(uint8_t c);
+    bool uart_bridge_tx_idle(void);
+    void uart_bridge_wait_tx_done(void);
+
+    uint32_t uart_bridge_set_baud(uint32_t baud);
+    uint32_t uart_bridge_get_baud(void);
+    void uart_bridge_set_stop_bits(uint bits);
+
+    bool uart_bridge_tap_attach(bridge_tap_t *tap, uint8_t *storage, uint32_t size);
+    bool uart_bridge_tap_attach_stamped(bridge_tap_t *tap, uint8_t *storage, uint32_t size);
+    void uart_bridge_tap_detach(bridge_tap_t *tap);
+
+    bool uart_bridge_job_attach(bridge_job_t job, void *ctx);
+    void uart_bridge_job_detach(void);
+
+    uint32_t uart_bridge_first_byte_us(void);
+    void uart_bridge_get_stats(bridge_stats_t *out);
+    void uart_bridge_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif